@@ -7,8 +7,10 @@
  */
 #define _GNU_SOURCE
 #include <stdio.h>
+#include <stddef.h>
 
 #include <pico/pico_int.h>
+#include <pico/memory.h>
 #include "debug.h"
 
 static char pdb_pending_cmds[128];
@@ -22,13 +24,34 @@ static struct pdb_cpu {
   unsigned int bpts[16];
   int bpt_count;
   int icount;
+  unsigned int trace_regs[32];
 } pdb_cpus[5];
 static int pdb_cpu_count;
 
 static int pdb_global_icount;
+static int pdb_recompile;
+
+// register snapshot, laid out like the pdb_net packet: pc, regs, io checksums
+static int pdb_cpu_regs(struct pdb_cpu *cpu, unsigned int pc, unsigned int *regs)
+{
+  int count = 0;
+
+#ifndef NO_32X
+  if (cpu->type == PDBCT_SH2) {
+    SH2 *sh2 = cpu->context;
+    int rl = offsetof(SH2, macl) + sizeof(sh2->macl);
+    regs[0] = pc;
+    memcpy(&regs[1], sh2->r, rl);
+    regs[1+24+0] = sh2->pdb_io_csum[0];
+    regs[1+24+1] = sh2->pdb_io_csum[1];
+    sh2->pdb_io_csum[0] = sh2->pdb_io_csum[1] = 0;
+    count = 1 + rl/4 + 2;
+  }
+#endif
+  return count;
+}
 
 #ifdef PDB_NET
-#include <stddef.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -65,10 +88,11 @@ int pdb_net_connect(const char *host, const char *port)
   printf("pdb_net: connected to %s:%s\n", host, port);
 
   pdb_net_sock = sock;
+  pdb_recompile = 1;
   return 0;
 }
 
-static int pdb_net_send(struct pdb_cpu *cpu, unsigned int pc)
+static int pdb_net_send(struct pdb_cpu *cpu, const unsigned int *regs, int count)
 {
   packet_t packet;
   int ret;
@@ -76,17 +100,11 @@ static int pdb_net_send(struct pdb_cpu *cpu, unsigned int pc)
   if (pdb_net_sock < 0)
     return 0; // not connected
 
-  if (cpu->type == PDBCT_SH2) {
-    SH2 *sh2 = cpu->context;
-    int rl = offsetof(SH2, macl) + sizeof(sh2->macl);
-    packet.header.type = PDBCT_SH2;
+  if (count > 0) {
+    packet.header.type = cpu->type;
     packet.header.cpuid = cpu->id;
-    packet.regs[0] = pc;
-    memcpy(&packet.regs[1], sh2->r, rl);
-    packet.regs[1+24+0] = sh2->pdb_io_csum[0];
-    packet.regs[1+24+1] = sh2->pdb_io_csum[1];
-    packet.header.len = 4 + rl + 4*2;
-    sh2->pdb_io_csum[0] = sh2->pdb_io_csum[1] = 0;
+    memcpy(packet.regs, regs, count * 4);
+    packet.header.len = count * 4;
   }
   else
     memset(&packet, 0, sizeof(packet));
@@ -99,14 +117,183 @@ static int pdb_net_send(struct pdb_cpu *cpu, unsigned int pc)
       printf("send: %d/%d\n", ret, sizeof(packet.header) + packet.header.len);
     close(pdb_net_sock);
     pdb_net_sock = -1;
+    pdb_recompile = 1;
     ret = -1;
   }
   return ret;
 }
 #else
-#define pdb_net_send(a,b) 0
+#define pdb_net_send(a,b,c) 0
 #endif // PDB_NET
 
+#ifdef PDB_TRACE
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <zlib.h>
+
+/*
+ * binary trace, gzip compressed. After a header ("PDBT", version, cpu count,
+ * then type and 0-terminated name for each cpu) there's a record per step:
+ *   u8      cpu id
+ *   varint  pc delta to the cpu's previous record, zigzag encoded
+ *   varint  mask of registers changed since then (bit n is regs[n+1])
+ *   varint  new ^ old for each changed register
+ * using the register layout of pdb_cpu_regs. Records are put into a lock-free
+ * ring, which a thread drains into the file, so that compression doesn't
+ * slow down the emulation thread.
+ */
+#define TRACE_RING_SIZE (1 << 22) // power of 2
+#define TRACE_REC_MAX   (1 + 5 + 5 + 31*5)
+
+static struct {
+  unsigned char *ring;
+  unsigned int head;  // written by the emulation thread only
+  unsigned int tail;  // written by the drain thread only
+  int running;
+  pthread_t thread;
+  gzFile f;
+} pdb_trace;
+
+static void *pdb_trace_drain(void *arg)
+{
+  struct timespec ts = { 0, 1000000 };
+  unsigned int head, tail = pdb_trace.tail;
+  unsigned int len, offs;
+  int running;
+
+  while (1) {
+    running = __atomic_load_n(&pdb_trace.running, __ATOMIC_ACQUIRE);
+    head = __atomic_load_n(&pdb_trace.head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      if (!running)
+        break;
+      nanosleep(&ts, NULL);
+      continue;
+    }
+
+    offs = tail & (TRACE_RING_SIZE - 1);
+    len = head - tail;
+    if (len > TRACE_RING_SIZE - offs)
+      len = TRACE_RING_SIZE - offs;
+    if (gzwrite(pdb_trace.f, pdb_trace.ring + offs, len) != len)
+      printf("pdb_trace: write error\n");
+    tail += len;
+    __atomic_store_n(&pdb_trace.tail, tail, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+static void pdb_trace_put(const unsigned char *rec, unsigned int len)
+{
+  unsigned int head = pdb_trace.head;
+  unsigned int offs = head & (TRACE_RING_SIZE - 1);
+  unsigned int l1 = len;
+
+  // ring full, wait for the drain thread
+  while (head - __atomic_load_n(&pdb_trace.tail, __ATOMIC_ACQUIRE)
+         > TRACE_RING_SIZE - len)
+    sched_yield();
+
+  if (l1 > TRACE_RING_SIZE - offs)
+    l1 = TRACE_RING_SIZE - offs;
+  memcpy(pdb_trace.ring + offs, rec, l1);
+  memcpy(pdb_trace.ring, rec + l1, len - l1);
+  __atomic_store_n(&pdb_trace.head, head + len, __ATOMIC_RELEASE);
+}
+
+static unsigned char *put_varint(unsigned char *p, unsigned int v)
+{
+  while (v >= 0x80) {
+    *p++ = v | 0x80;
+    v >>= 7;
+  }
+  *p++ = v;
+  return p;
+}
+
+static void pdb_trace_step(struct pdb_cpu *cpu, const unsigned int *regs, int count)
+{
+  unsigned char rec[TRACE_REC_MAX], *p = rec;
+  unsigned int *old = cpu->trace_regs;
+  unsigned int mask = 0;
+  int d, i;
+
+  if (!pdb_trace.running || count == 0)
+    return;
+
+  *p++ = cpu->id;
+  d = regs[0] - old[0];
+  p = put_varint(p, ((unsigned int)d << 1) ^ (d >> 31));
+  for (i = 1; i < count; i++)
+    if (regs[i] != old[i])
+      mask |= 1 << (i - 1);
+  p = put_varint(p, mask);
+  for (i = 1; i < count; i++) {
+    if (mask & (1 << (i - 1))) {
+      p = put_varint(p, regs[i] ^ old[i]);
+      old[i] = regs[i];
+    }
+  }
+  old[0] = regs[0];
+
+  pdb_trace_put(rec, p - rec);
+}
+
+static void pdb_trace_stop(void)
+{
+  if (!pdb_trace.running)
+    return;
+
+  __atomic_store_n(&pdb_trace.running, 0, __ATOMIC_RELEASE);
+  pthread_join(pdb_trace.thread, NULL);
+  gzclose(pdb_trace.f);
+  free(pdb_trace.ring);
+  pdb_trace.ring = NULL;
+  printf("pdb_trace: stopped, %u bytes\n", pdb_trace.head);
+}
+
+static int pdb_trace_start(const char *fname)
+{
+  int i;
+
+  pdb_trace_stop();
+
+  pdb_trace.f = gzopen(fname, "wb1");
+  pdb_trace.ring = malloc(TRACE_RING_SIZE);
+  if (pdb_trace.f == NULL || pdb_trace.ring == NULL)
+    goto fail;
+
+  gzwrite(pdb_trace.f, "PDBT\x01", 5);
+  gzputc(pdb_trace.f, pdb_cpu_count);
+  for (i = 0; i < pdb_cpu_count; i++) {
+    gzputc(pdb_trace.f, pdb_cpus[i].type);
+    gzwrite(pdb_trace.f, pdb_cpus[i].name, strlen(pdb_cpus[i].name) + 1);
+    memset(pdb_cpus[i].trace_regs, 0, sizeof(pdb_cpus[i].trace_regs));
+  }
+
+  pdb_trace.head = pdb_trace.tail = 0;
+  pdb_trace.running = 1;
+  if (pthread_create(&pdb_trace.thread, NULL, pdb_trace_drain, NULL) != 0) {
+    pdb_trace.running = 0;
+    goto fail;
+  }
+  printf("pdb_trace: writing to %s\n", fname);
+  return 0;
+
+fail:
+  perror("pdb_trace");
+  if (pdb_trace.f != NULL)
+    gzclose(pdb_trace.f);
+  free(pdb_trace.ring);
+  pdb_trace.ring = NULL;
+  return -1;
+}
+#else
+static inline void pdb_trace_step(struct pdb_cpu *cpu, const unsigned int *regs, int count) {}
+#define pdb_trace_stop()
+#endif // PDB_TRACE
+
 #ifdef HAVE_READLINE
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -194,6 +381,12 @@ enum cmd_ret_e {
 static int do_print(struct pdb_cpu *cpu, const char *args)
 {
   elprintf(EL_STATUS, "cpu %d (%s)", cpu->id, cpu->name);
+  if (cpu->type == PDBCT_M68K) {
+    int i;
+    printf("PC,SR %06x,  %04x\n", SekPc, SekSr);
+    for (i = 0; i < 8; i++)
+      printf("D%d,A%d %08x,%08x\n", i, i, SekDar(i), SekDar(i + 8));
+  }
 #ifndef NO_32X
   if (cpu->type == PDBCT_SH2) {
     SH2 *sh2 = cpu->context;
@@ -204,7 +397,7 @@ static int do_print(struct pdb_cpu *cpu, const char *args)
     printf("gb,vb %08x,%08x\n", sh2->gbr, sh2->vbr);
     printf("IRQs/mask:        %02x/%02x\n", Pico32x.sh2irqi[sh2->is_slave],
       Pico32x.sh2irq_mask[sh2->is_slave]);
-    printf("cycles %d/%d (%d)\n", sh2->cycles_done, sh2->cycles_aim, (signed int)sh2->sr >> 12);
+    printf("cycles %u/%u (%d)\n", sh2->m68krcycles_done, sh2->cycles_timeslice, (signed int)sh2->sr >> 12);
   }
 #endif
   return CMDRET_DONE;
@@ -219,6 +412,7 @@ static int do_step_all(struct pdb_cpu *cpu, const char *args)
   }
 
   pdb_global_icount = atoi(tmp);
+  pdb_recompile = 1;
   return CMDRET_CONT_DO_NEXT;
 }
 
@@ -227,6 +421,7 @@ static int do_continue(struct pdb_cpu *cpu, const char *args)
   char tmp[32];
   if (get_arg(tmp, sizeof(tmp), args))
     cpu->icount = atoi(tmp);
+  pdb_recompile = 1;
   return CMDRET_CONT_DO_NEXT;
 }
 
@@ -249,6 +444,262 @@ static int do_waitcpu(struct pdb_cpu *cpu, const char *args)
   return CMDRET_CONT_REDO;
 }
 
+#ifdef PDB_TRACE
+static int do_trace(struct pdb_cpu *cpu, const char *args)
+{
+  char tmp[256];
+  if (!get_arg(tmp, sizeof(tmp), args) || strcmp(tmp, "off") == 0)
+    pdb_trace_stop();
+  else
+    pdb_trace_start(tmp);
+  pdb_recompile = 1;
+  return CMDRET_DONE;
+}
+#endif
+
+static int do_break(struct pdb_cpu *cpu, const char *args)
+{
+  char tmp[32];
+  int i;
+
+  if (!get_arg(tmp, sizeof(tmp), args)) {
+    for (i = 0; i < cpu->bpt_count; i++)
+      printf("%d: %08x\n", i, cpu->bpts[i]);
+    return CMDRET_DONE;
+  }
+  if (cpu->bpt_count >= ARRAY_SIZE(cpu->bpts)) {
+    printf("break: too many breakpoints\n");
+    return CMDRET_DONE;
+  }
+  cpu->bpts[cpu->bpt_count++] = strtoul(tmp, NULL, 16);
+  pdb_recompile = 1;
+  return CMDRET_DONE;
+}
+
+static int do_delete(struct pdb_cpu *cpu, const char *args)
+{
+  char tmp[32];
+  unsigned int addr;
+  int i;
+
+  pdb_recompile = 1;
+  if (!get_arg(tmp, sizeof(tmp), args)) {
+    cpu->bpt_count = 0;
+    return CMDRET_DONE;
+  }
+  addr = strtoul(tmp, NULL, 16);
+  for (i = 0; i < cpu->bpt_count; i++)
+    if (cpu->bpts[i] == addr)
+      cpu->bpts[i--] = cpu->bpts[--cpu->bpt_count];
+  return CMDRET_DONE;
+}
+
+/*
+ * 68k watchpoints. The map entries of the 64K pages containing a watched
+ * range are replaced by checking handlers, which call the replaced entries.
+ * Other pages run at full speed. The memory code calls pdb_watch_remap when
+ * it changes the maps, so that the watches survive bank switching.
+ */
+#define WATCH_R 1
+#define WATCH_W 2
+#define WATCH_PAGES (0x1000000 >> M68K_MEM_SHIFT)
+
+#ifdef __EMSCRIPTEN__
+#define WATCH_MAP_ENTRY(f) ((uptr)(f) | MAP_FLAG)
+#else
+#define WATCH_MAP_ENTRY(f) (((uptr)(f) >> 1) | MAP_FLAG)
+#endif
+
+static struct {
+  u32 start, end; // inclusive
+  int flags;
+} pdb_watches[8];
+static int pdb_watch_count;
+
+static uptr *const pdb_watch_maps[4] = {
+  m68k_read8_map, m68k_read16_map, m68k_write8_map, m68k_write16_map
+};
+static uptr pdb_watch_orig[4][WATCH_PAGES];
+static uptr pdb_watch_entry[4];
+static u8 pdb_watch_pages[WATCH_PAGES];
+
+static struct pdb_cpu *pdb_m68k_cpu(void)
+{
+  int i;
+  for (i = 0; i < pdb_cpu_count; i++)
+    if (pdb_cpus[i].type == PDBCT_M68K)
+      return &pdb_cpus[i];
+  pdb_register_cpu(NULL, PDBCT_M68K, "m68k");
+  return &pdb_cpus[i];
+}
+
+static void do_prompt(struct pdb_cpu *cpu);
+
+static void pdb_watch_hit(u32 a, int size, u32 d, int flags)
+{
+  int i;
+
+  for (i = 0; i < pdb_watch_count; i++)
+    if ((pdb_watches[i].flags & flags) && a <= pdb_watches[i].end &&
+        a + size - 1 >= pdb_watches[i].start)
+      break;
+  if (i == pdb_watch_count)
+    return;
+
+  printf("m68k %c%d [%06x] %0*x @%06x\n", flags & WATCH_R ? 'r' : 'w',
+    size * 8, a, size * 2, d, SekPc);
+  do_prompt(pdb_m68k_cpu());
+}
+
+static u32 watch_read(uptr v, u32 a, int size)
+{
+  if (map_flag_set(v))
+    return ((cpu68k_read_f *)M68K_HANDLER_PTR(v))(a);
+  if (size == 1)
+    return *(u8 *)((v << 1) + MEM_BE2(a));
+  return *(u16 *)((v << 1) + a);
+}
+
+static void watch_write(uptr v, u32 a, u32 d, int size)
+{
+  if (map_flag_set(v))
+    ((cpu68k_write_f *)M68K_HANDLER_PTR(v))(a, d);
+  else if (size == 1)
+    *(u8 *)((v << 1) + MEM_BE2(a)) = d;
+  else
+    *(u16 *)((v << 1) + a) = d;
+}
+
+static u32 watch_read8(u32 a)
+{
+  u32 d = watch_read(pdb_watch_orig[0][(a & 0xffffff) >> M68K_MEM_SHIFT], a & 0xffffff, 1);
+  pdb_watch_hit(a & 0xffffff, 1, d, WATCH_R);
+  return d;
+}
+
+static u32 watch_read16(u32 a)
+{
+  u32 d = watch_read(pdb_watch_orig[1][(a & 0xfffffe) >> M68K_MEM_SHIFT], a & 0xfffffe, 2);
+  pdb_watch_hit(a & 0xfffffe, 2, d, WATCH_R);
+  return d;
+}
+
+static void watch_write8(u32 a, u32 d)
+{
+  pdb_watch_hit(a & 0xffffff, 1, d & 0xff, WATCH_W);
+  watch_write(pdb_watch_orig[2][(a & 0xffffff) >> M68K_MEM_SHIFT], a & 0xffffff, d, 1);
+}
+
+static void watch_write16(u32 a, u32 d)
+{
+  pdb_watch_hit(a & 0xfffffe, 2, d & 0xffff, WATCH_W);
+  watch_write(pdb_watch_orig[3][(a & 0xfffffe) >> M68K_MEM_SHIFT], a & 0xfffffe, d, 2);
+}
+
+// (un)install the checking handlers on the pages of the current watches
+static void pdb_watch_install(void)
+{
+  u8 pages[WATCH_PAGES] = { 0, };
+  int i, m, p;
+
+  pdb_watch_entry[0] = WATCH_MAP_ENTRY(watch_read8);
+  pdb_watch_entry[1] = WATCH_MAP_ENTRY(watch_read16);
+  pdb_watch_entry[2] = WATCH_MAP_ENTRY(watch_write8);
+  pdb_watch_entry[3] = WATCH_MAP_ENTRY(watch_write16);
+
+  for (i = 0; i < pdb_watch_count; i++)
+    for (p = pdb_watches[i].start >> M68K_MEM_SHIFT;
+         p <= pdb_watches[i].end >> M68K_MEM_SHIFT; p++)
+      pages[p] = 1;
+
+  for (p = 0; p < WATCH_PAGES; p++) {
+    if (pages[p] == pdb_watch_pages[p])
+      continue;
+    for (m = 0; m < 4; m++) {
+      if (pages[p]) {
+        pdb_watch_orig[m][p] = pdb_watch_maps[m][p];
+        pdb_watch_maps[m][p] = pdb_watch_entry[m];
+      } else
+        pdb_watch_maps[m][p] = pdb_watch_orig[m][p];
+    }
+    pdb_watch_pages[p] = pages[p];
+  }
+}
+
+// the memory code has changed the maps, take over new entries on watched pages
+void pdb_watch_remap(void)
+{
+  int m, p;
+
+  if (pdb_watch_count == 0)
+    return;
+  for (p = 0; p < WATCH_PAGES; p++) {
+    if (!pdb_watch_pages[p])
+      continue;
+    for (m = 0; m < 4; m++) {
+      if (pdb_watch_maps[m][p] != pdb_watch_entry[m]) {
+        pdb_watch_orig[m][p] = pdb_watch_maps[m][p];
+        pdb_watch_maps[m][p] = pdb_watch_entry[m];
+      }
+    }
+  }
+}
+
+static int do_watch(struct pdb_cpu *cpu, const char *args)
+{
+  char tmp[32];
+  u32 start, len = 1;
+  int flags = WATCH_R|WATCH_W;
+  int i;
+
+  if (!(args = get_arg(tmp, sizeof(tmp), args))) {
+    for (i = 0; i < pdb_watch_count; i++)
+      printf("%d: %06x-%06x %s%s\n", i, pdb_watches[i].start, pdb_watches[i].end,
+        pdb_watches[i].flags & WATCH_R ? "r" : "", pdb_watches[i].flags & WATCH_W ? "w" : "");
+    return CMDRET_DONE;
+  }
+  if (pdb_watch_count >= ARRAY_SIZE(pdb_watches)) {
+    printf("watch: too many watchpoints\n");
+    return CMDRET_DONE;
+  }
+  start = strtoul(tmp, NULL, 16) & 0xffffff;
+  if ((args = get_arg(tmp, sizeof(tmp), args))) {
+    len = strtoul(tmp, NULL, 0);
+    if (get_arg(tmp, sizeof(tmp), args))
+      flags = (strchr(tmp, 'r') ? WATCH_R : 0) | (strchr(tmp, 'w') ? WATCH_W : 0);
+  }
+  if (len == 0 || flags == 0 || start + len > 0x1000000) {
+    printf("watch: bad args\n");
+    return CMDRET_DONE;
+  }
+
+  pdb_watches[pdb_watch_count].start = start;
+  pdb_watches[pdb_watch_count].end = start + len - 1;
+  pdb_watches[pdb_watch_count].flags = flags;
+  pdb_watch_count++;
+  pdb_m68k_cpu();
+  pdb_watch_install();
+  return CMDRET_DONE;
+}
+
+static int do_unwatch(struct pdb_cpu *cpu, const char *args)
+{
+  char tmp[32];
+  u32 addr;
+  int i;
+
+  if (!get_arg(tmp, sizeof(tmp), args))
+    pdb_watch_count = 0;
+  else {
+    addr = strtoul(tmp, NULL, 16) & 0xffffff;
+    for (i = 0; i < pdb_watch_count; i++)
+      if (pdb_watches[i].start <= addr && addr <= pdb_watches[i].end)
+        pdb_watches[i--] = pdb_watches[--pdb_watch_count];
+  }
+  pdb_watch_install();
+  return CMDRET_DONE;
+}
+
 static int do_help(struct pdb_cpu *cpu, const char *args);
 
 static struct {
@@ -262,6 +713,13 @@ static struct {
   { "step_all", "<insns>",   do_step_all },
   { "waitcpu",  "<cpuname>", do_waitcpu },
   { "print",    "",          do_print },
+  { "break",    "[addr]",    do_break },
+  { "delete",   "[addr]",    do_delete },
+  { "watch",    "[addr [len [r|w|rw]]]", do_watch },
+  { "unwatch",  "[addr]",    do_unwatch },
+#ifdef PDB_TRACE
+  { "trace",    "<file>|off", do_trace },
+#endif
 };
 
 static int do_help(struct pdb_cpu *cpu, const char *args)
@@ -272,9 +730,15 @@ static int do_help(struct pdb_cpu *cpu, const char *args)
   return CMDRET_DONE;
 }
 
-static int do_comands(struct pdb_cpu *cpu, const char *cmds)
+static int pdb_cmds_pending(void)
+{
+  return pdb_pending_cmds[0] != 0 || pdb_event_cmds[0] != 0;
+}
+
+static int run_comands(struct pdb_cpu *cpu, const char *cmds)
 {
   const char *p = cmds;
+
   while (p != NULL)
   {
     const char *pcmd;
@@ -326,6 +790,17 @@ static int do_comands(struct pdb_cpu *cpu, const char *cmds)
   return 1;
 }
 
+static int do_comands(struct pdb_cpu *cpu, const char *cmds)
+{
+  int pending = pdb_cmds_pending();
+  int ret = run_comands(cpu, cmds);
+
+  // pending commands need pdb_step at all block entries
+  if (pdb_cmds_pending() != pending)
+    pdb_recompile = 1;
+  return ret;
+}
+
 static void do_prompt(struct pdb_cpu *cpu)
 {
   static char prev[128];
@@ -367,9 +842,12 @@ void pdb_register_cpu(void *context, int type, const char *name)
 void pdb_step(void *context, unsigned int pc)
 {
   struct pdb_cpu *cpu = context2cpu(context);
-  int i;
+  unsigned int regs[32];
+  int i, count;
 
-  if (pdb_net_send(cpu, pc) < 0)
+  count = pdb_cpu_regs(cpu, pc, regs);
+  pdb_trace_step(cpu, regs, count);
+  if (pdb_net_send(cpu, regs, count) < 0)
     goto prompt;
 
   if (pdb_pending_cmds[0] != 0)
@@ -381,14 +859,18 @@ void pdb_step(void *context, unsigned int pc)
     if (cpu->bpts[i] == pc)
       goto prompt;
 
-  // hit num of insns?
+  // hit num of insns? Stepping is done, drop the hooks at all entries
   if (pdb_global_icount > 0)
-    if (--pdb_global_icount == 0)
+    if (--pdb_global_icount == 0) {
+      pdb_recompile = 1;
       goto prompt;
+    }
 
   if (cpu->icount > 0)
-    if (--(cpu->icount) == 0)
+    if (--(cpu->icount) == 0) {
+      pdb_recompile = 1;
       goto prompt;
+    }
 
   return;
 
@@ -403,12 +885,76 @@ prompt:
 
 void pdb_command(const char *cmd)
 {
+  int pending = pdb_cmds_pending();
+
   strncpy(pdb_pending_cmds, cmd, sizeof(pdb_pending_cmds));
   pdb_pending_cmds[sizeof(pdb_pending_cmds) - 1] = 0;
+  if (pdb_cmds_pending() != pending)
+    pdb_recompile = 1;
+}
+
+// without SH2s there are no steps, run pending commands once per frame instead
+void pdb_frame(void)
+{
+  int i;
+
+  if (pdb_pending_cmds[0] == 0)
+    return;
+  for (i = 0; i < pdb_cpu_count; i++)
+    if (pdb_cpus[i].type == PDBCT_SH2)
+      return;
+  if (do_comands(pdb_m68k_cpu(), pdb_pending_cmds))
+    do_prompt(pdb_m68k_cpu());
+}
+
+// the DRC only calls pdb_step at block entries for which this is true.
+// Stepping, tracing and pending commands need all entries, else only the
+// breakpoints do, and everything else runs at full speed.
+int pdb_bpt_check(unsigned int pc)
+{
+  int i;
+
+  if (pdb_cmds_pending() || pdb_global_icount > 0)
+    return 1;
+#ifdef PDB_NET
+  if (pdb_net_sock >= 0)
+    return 1;
+#endif
+#ifdef PDB_TRACE
+  if (pdb_trace.running)
+    return 1;
+#endif
+  for (i = 0; i < pdb_cpu_count; i++)
+    if (pdb_cpus[i].icount > 0)
+      return 1;
+  return pdb_bpt_at(pc);
+}
+
+// the DRC makes a block entry at each breakpoint address
+int pdb_bpt_at(unsigned int pc)
+{
+  int i, j;
+
+  for (i = 0; i < pdb_cpu_count; i++)
+    for (j = 0; j < pdb_cpus[i].bpt_count; j++)
+      if (pdb_cpus[i].bpts[j] == pc)
+        return 1;
+  return 0;
+}
+
+// translated code must be dropped since pdb_bpt_check results have changed
+int pdb_recompile_pending(void)
+{
+  int ret = pdb_recompile;
+  pdb_recompile = 0;
+  return ret;
 }
 
 void pdb_cleanup(void)
 {
+  pdb_watch_count = 0;
+  pdb_watch_install();
+  pdb_trace_stop();
   pdb_cpu_count = 0;
 }
 
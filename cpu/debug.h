@@ -3,12 +3,18 @@
 
 enum {
   PDBCT_SH2,
+  PDBCT_M68K,
 };
 
 void pdb_register_cpu(void *context, int type, const char *name);
 void pdb_cleanup(void);
 void pdb_step(void *context, unsigned int pc);
 void pdb_command(const char *cmd);
+void pdb_frame(void);
+int  pdb_bpt_check(unsigned int pc);
+int  pdb_bpt_at(unsigned int pc);
+int  pdb_recompile_pending(void);
+void pdb_watch_remap(void);
 
 #else
 
@@ -16,6 +22,11 @@ void pdb_command(const char *cmd);
 #define pdb_cleanup()
 #define pdb_step(a,b)
 #define pdb_command(a)
+#define pdb_frame()
+#define pdb_bpt_check(a) 0
+#define pdb_bpt_at(a) 0
+#define pdb_recompile_pending() 0
+#define pdb_watch_remap()
 
 #endif
 
@@ -5,11 +5,24 @@
  * This work is licensed under the terms of MAME license.
  * See COPYING file in the top-level directory.
  */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // memfd_create
+#endif
 #include <stdio.h>
 
 #include <pico/pico_int.h>
 #include "cmn.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define DRC_MMAP
+#ifdef MFD_CLOEXEC
+#define DRC_DUAL_MAP
+#endif
+#define HUGEPAGE_SIZE (2*1024*1024)
+#endif
+
 #if defined(__linux__) && (defined(__aarch64__) || defined(__VFP_FP__))
 // might be running on a 64k-page kernel
 #define PICO_PAGE_ALIGN 65536
@@ -18,18 +31,105 @@
 #endif
 u8 ALIGNED(PICO_PAGE_ALIGN) tcache_default[DRC_TCACHE_SIZE];
 u8 *tcache;
+uptr tcache_rw_offs;
+
+#ifdef DRC_MMAP
+// own mappings, if any. tcache_rw is the writable view if dual mapped
+static u8 *tcache_map, *tcache_rw;
+
+// anonymous mapping aligned to huge pages, so that THP can back it
+static u8 *tcache_map_huge(void)
+{
+  size_t size = DRC_TCACHE_SIZE + HUGEPAGE_SIZE;
+  u8 *p, *a;
+
+  p = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    return NULL;
+
+  // cut off the unaligned parts at both ends
+  a = (u8 *)(((uptr)p + HUGEPAGE_SIZE-1) & ~(uptr)(HUGEPAGE_SIZE-1));
+  if (a > p)
+    munmap(p, a - p);
+  if (p + size > a + DRC_TCACHE_SIZE)
+    munmap(a + DRC_TCACHE_SIZE, p + size - (a + DRC_TCACHE_SIZE));
+#ifdef MADV_HUGEPAGE
+  madvise(a, DRC_TCACHE_SIZE, MADV_HUGEPAGE);
+#endif
+  return a;
+}
+#endif
+
+#ifdef DRC_DUAL_MAP
+// W^X: map the same memory twice, once writable and once executable
+static u8 *tcache_map_dual(int huge)
+{
+  u8 *rw = MAP_FAILED, *rx = MAP_FAILED;
+  int fd = -1;
+
+#ifdef MFD_HUGETLB
+  if (huge) {
+    // needs reserved hugetlbfs pages, mapping fails if there aren't enough
+    fd = memfd_create("picodrive-drc", MFD_CLOEXEC|MFD_HUGETLB);
+    if (fd >= 0 && ftruncate(fd, DRC_TCACHE_SIZE) == 0)
+      rw = mmap(NULL, DRC_TCACHE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (rw == MAP_FAILED && fd >= 0)
+      close(fd), fd = -1;
+  }
+#endif
+  if (fd < 0) {
+    fd = memfd_create("picodrive-drc", MFD_CLOEXEC);
+    if (fd < 0)
+      return NULL;
+    if (ftruncate(fd, DRC_TCACHE_SIZE) == 0)
+      rw = mmap(NULL, DRC_TCACHE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (rw != MAP_FAILED)
+    rx = mmap(NULL, DRC_TCACHE_SIZE, PROT_READ|PROT_EXEC, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (rx == MAP_FAILED) {
+    if (rw != MAP_FAILED)
+      munmap(rw, DRC_TCACHE_SIZE);
+    return NULL;
+  }
+  tcache_rw = rw;
+  return rx;
+}
+#endif
 
 void drc_cmn_init(void)
 {
+  int huge = !!(PicoIn.opt & POPT_EN_DRC_HUGEPAGE);
   int ret;
 
+  drc_cmn_cleanup(); // drop mappings left from a previous init
+  tcache_rw_offs = 0;
   tcache = plat_mem_get_for_drc(DRC_TCACHE_SIZE);
+#ifdef DRC_MMAP
+  if (tcache == NULL && huge)
+    tcache = tcache_map = tcache_map_huge();
+#endif
   if (tcache == NULL)
     tcache = tcache_default;
 
   ret = plat_mem_set_exec(tcache, DRC_TCACHE_SIZE);
-  elprintf(EL_STATUS, "drc_cmn_init: %p, %zd bytes: %d",
-    tcache, DRC_TCACHE_SIZE, ret);
+#ifdef DRC_DUAL_MAP
+  if (ret != 0) {
+    // RWX memory refused, probably due to a W^X policy. Use 2 views instead
+    u8 *rx = tcache_map_dual(huge);
+    if (rx != NULL) {
+      if (tcache_map != NULL)
+        munmap(tcache_map, DRC_TCACHE_SIZE);
+      tcache = tcache_map = rx;
+      tcache_rw_offs = tcache_rw - rx;
+      ret = 0;
+    }
+  }
+#endif
+  elprintf(EL_STATUS, "drc_cmn_init: %p, %zd bytes: %d%s%s",
+    tcache, DRC_TCACHE_SIZE, ret, tcache_rw_offs ? ", dual mapped" : "",
+    huge ? ", huge pages" : "");
 
 #ifdef __arm__
   if (PicoIn.opt & POPT_EN_DRC)
@@ -37,13 +137,13 @@ void drc_cmn_init(void)
     static int test_done;
     if (!test_done)
     {
-      int *test_out = (void *)tcache;
+      int *test_out = TCACHE_RW(tcache);
       int (*testfunc)(void) = (void *)tcache;
 
       elprintf(EL_STATUS, "testing if we can run recompiled code..");
       *test_out++ = 0xe3a000dd; // mov r0, 0xdd
       *test_out++ = 0xe12fff1e; // bx lr
-      cache_flush_d_inval_i(tcache, test_out);
+      cache_flush_d_inval_i(tcache, tcache + 8);
 
       // we'll usually crash on broken platforms or bad ports,
       // but do a value check too just in case
@@ -57,6 +157,18 @@ void drc_cmn_init(void)
 
 void drc_cmn_cleanup(void)
 {
+#ifdef DRC_MMAP
+  if (tcache_map != NULL) {
+    if (tcache == tcache_map)
+      tcache = NULL;
+    munmap(tcache_map, DRC_TCACHE_SIZE);
+    tcache_map = NULL;
+  }
+  if (tcache_rw != NULL) {
+    munmap(tcache_rw, DRC_TCACHE_SIZE);
+    tcache_rw = NULL;
+  }
+#endif
 }
 
 // vim:shiftwidth=2:expandtab
@@ -2,6 +2,11 @@
 #define DRC_TCACHE_SIZE         (4*1024*1024)
 
 extern u8 *tcache;
+extern uptr tcache_rw_offs;
+
+// code is generated for its execution address; stores into the cache must go
+// through the writable view, which is elsewhere if the cache is dual mapped
+#define TCACHE_RW(p) ((void *)((u8 *)(p) + tcache_rw_offs))
 
 void drc_cmn_init(void);
 void drc_cmn_cleanup(void);
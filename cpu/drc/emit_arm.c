@@ -25,7 +25,7 @@
 // XXX: tcache_ptr type for SVP and SH2 compilers differs..
 #define EMIT_PTR(ptr, x) \
 	do { \
-		*(u32 *)ptr = x; \
+		*(u32 *)TCACHE_RW(ptr) = x; \
 		ptr = (void *)((u8 *)ptr + sizeof(u32)); \
 	} while (0)
 
@@ -357,9 +357,12 @@ static void emith_flush(void)
 #define EOP_LDR_REG_LSL_WB(cond,rd,rn,rm,shift_imm) EOP_C_AM2_REG(cond,1,0,3,rn,rd,shift_imm,A_AM1_LSL,rm)
 #define EOP_LDRB_REG_LSL(cond,rd,rn,rm,shift_imm) EOP_C_AM2_REG(cond,1,1,1,rn,rd,shift_imm,A_AM1_LSL,rm)
 #define EOP_STR_REG_LSL_WB(cond,rd,rn,rm,shift_imm) EOP_C_AM2_REG(cond,1,0,2,rn,rd,shift_imm,A_AM1_LSL,rm)
+#define EOP_STR_REG_LSL(cond,rd,rn,rm,shift_imm)  EOP_C_AM2_REG(cond,1,0,0,rn,rd,shift_imm,A_AM1_LSL,rm)
+#define EOP_STRB_REG_LSL(cond,rd,rn,rm,shift_imm) EOP_C_AM2_REG(cond,1,1,0,rn,rd,shift_imm,A_AM1_LSL,rm)
 
 #define EOP_LDRH_IMM2(cond,rd,rn,offset_8)  EOP_C_AM3_IMM(cond,(offset_8) >= 0,1,rn,rd,0,1,pabs(offset_8))
 #define EOP_LDRH_REG2(cond,rd,rn,rm)        EOP_C_AM3_REG(cond,1,1,rn,rd,0,1,rm)
+#define EOP_STRH_REG2(cond,rd,rn,rm)        EOP_C_AM3_REG(cond,1,0,rn,rd,0,1,rm)
 
 #define EOP_LDRH_IMM(   rd,rn,offset_8)  EOP_C_AM3_IMM(insn_cond,(offset_8) >= 0,1,rn,rd,0,1,pabs(offset_8))
 #define EOP_LDRH_SIMPLE(rd,rn)           EOP_C_AM3_IMM(insn_cond,1,1,rn,rd,0,1,0)
@@ -636,9 +639,10 @@ static void emith_pool_commit(int jumpover)
 		exit(1);
 	}
 	// copy pool and adjust addresses in insns accessing the pool
-	memcpy(pool, literal_pool, sz);
+	memcpy(TCACHE_RW(pool), literal_pool, sz);
 	for (i = 0; i < literal_iindex; i++) {
-		*literal_insn[i] += (u8 *)pool - ((u8 *)literal_insn[i] + 8);
+		u32 *pi = TCACHE_RW(literal_insn[i]);
+		*pi += (u8 *)pool - ((u8 *)literal_insn[i] + 8);
 	}
 	// count pool constants as insns for statistics
 	for (i = 0; i < literal_pindex; i++)
@@ -689,6 +693,16 @@ static int insn_cond = A_COND_AL;
 	JMP_EMIT(cond, cond_ptr); \
 }
 
+#define EMITH_JMP3_START(cond) \
+{	void *cond_ptr, *else_ptr; \
+	JMP_POS(cond_ptr)
+#define EMITH_JMP3_MID(cond) \
+	JMP_POS(else_ptr); \
+	JMP_EMIT(cond, cond_ptr);
+#define EMITH_JMP3_END() \
+	JMP_EMIT(A_COND_AL, else_ptr); \
+}
+
 // fake "simple" or "short" jump - using cond insns instead
 #define EMITH_COND_START(cond) \
 {	int insn_cond = (cond)^1;
@@ -1065,6 +1079,12 @@ static int insn_cond = A_COND_AL;
 	EOP_STR_IMM2(insn_cond, r, rs, offs)
 #define emith_write_r_r_offs_ptr(r, rs, offs) \
 	emith_write_r_r_offs(r, rs, offs)
+#define emith_write_r_r_r(r, rs, rm) \
+	EOP_STR_REG_LSL(insn_cond, r, rs, rm, 0)
+#define emith_write8_r_r_r(r, rs, rm) \
+	EOP_STRB_REG_LSL(insn_cond, r, rs, rm, 0)
+#define emith_write16_r_r_r(r, rs, rm) \
+	EOP_STRH_REG2(insn_cond, r, rs, rm)
 
 #define emith_ctx_read(r, offs) \
 	emith_read_r_r_offs(r, CONTEXT_REG, offs)
@@ -1153,7 +1173,7 @@ static int insn_cond = A_COND_AL;
 #define emith_jump_patch(ptr, target, pos) do { \
 	u32 *ptr_ = (u32 *)ptr; \
 	u32 val_ = (u32 *)(target) - ptr_ - 2; \
-	*ptr_ = (*ptr_ & 0xff000000) | (val_ & 0x00ffffff); \
+	*(u32 *)TCACHE_RW(ptr_) = (*ptr_ & 0xff000000) | (val_ & 0x00ffffff); \
 	if ((void *)(pos) != NULL) *(u8 **)(pos) = (u8 *)ptr; \
 } while (0)
 #define emith_jump_patch_inrange(ptr, target) !0
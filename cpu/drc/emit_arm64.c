@@ -336,7 +336,7 @@ enum { AM_IDX, AM_IDXPOST, AM_IDXREG, AM_IDXPRE };
 // XXX: tcache_ptr type for SVP and SH2 compilers differs..
 #define EMIT_PTR(ptr, x) \
 	do { \
-		*(u32 *)(ptr) = x; \
+		*(u32 *)TCACHE_RW(ptr) = x; \
 		ptr = (void *)((u8 *)(ptr) + sizeof(u32)); \
 	} while (0)
 
@@ -942,6 +942,12 @@ static void emith_ldst_offs(int sz, int rd, int rn, int o9, int ld, int mode)
 #define emith_write_r_r_r(r, rs, rm) \
 	EMIT(A64_LDST_REG(r, rs, rm, LT_ST, XT_SXTW))
 
+#define emith_write8_r_r_r(r, rs, rm) \
+	EMIT(A64_LDSTB_REG(r, rs, rm, LT_ST, XT_SXTW))
+
+#define emith_write16_r_r_r(r, rs, rm) \
+	EMIT(A64_LDSTH_REG(r, rs, rm, LT_ST, XT_SXTW))
+
 #define emith_ctx_read_ptr(r, offs) \
 	emith_read_r_r_offs_ptr(r, CONTEXT_REG, offs)
 
@@ -483,7 +483,7 @@ enum { OPS_STD, OPS_STDU /*,OPS_STQ*/ };
 // XXX: tcache_ptr type for SVP and SH2 compilers differs..
 #define EMIT_PTR(ptr, x) \
 	do { \
-		*(u32 *)(ptr) = x; \
+		*(u32 *)TCACHE_RW(ptr) = x; \
 		ptr = (void *)((u8 *)(ptr) + sizeof(u32)); \
 	} while (0)
 
@@ -1197,6 +1197,12 @@ static void emith_add_imm(int rt, int ra, u32 imm)
 #define emith_write_r_r_r(r, ra, rm) \
 	EMIT(PPC_STW_REG(r, ra, rm))
 
+#define emith_write8_r_r_r(r, ra, rm) \
+	EMIT(PPC_STB_REG(r, ra, rm))
+
+#define emith_write16_r_r_r(r, ra, rm) \
+	EMIT(PPC_STH_REG(r, ra, rm))
+
 #define emith_ctx_read_ptr(r, offs) \
 	emith_read_r_r_offs_ptr(r, CONTEXT_REG, offs)
 
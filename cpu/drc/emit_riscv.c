@@ -270,7 +270,7 @@ enum { F2_ALT=0x20, F2_MULDIV=0x01 };
 // XXX: tcache_ptr type for SVP and SH2 compilers differs..
 #define EMIT_PTR(ptr, x) \
 	do { \
-		*(u32 *)(ptr) = x; \
+		*(u32 *)TCACHE_RW(ptr) = x; \
 		ptr = (void *)((u8 *)(ptr) + sizeof(u32)); \
 	} while (0)
 
@@ -677,9 +677,10 @@ static void emith_pool_commit(int jumpover)
 		exit(1);
 	}
 	// copy pool and adjust addresses in insns accessing the pool
-	memcpy(pool, literal_pool, sz);
+	memcpy(TCACHE_RW(pool), literal_pool, sz);
 	for (i = 0; i < literal_iindex; i++) {
-		*literal_insn[i] += ((u8 *)pool - (u8 *)literal_insn[i]) << 20;
+		u32 *pi = TCACHE_RW(literal_insn[i]);
+		*pi += ((u8 *)pool - (u8 *)literal_insn[i]) << 20;
 	}
 	// count pool constants as insns for statistics
 	for (i = 0; i < literal_pindex * sizeof(uintptr_t)/sizeof(u32); i++)
@@ -1084,6 +1085,16 @@ static void emith_st_offs(int sz, int rt, int rs, int o12)
 	emith_st_offs(F1_W, r, AT, 0); \
 } while (0)
 
+#define emith_write8_r_r_r(r, rs, rm) do { \
+	emith_add_r_r_r_ptr(AT, rs, rm); \
+	emith_st_offs(F1_B, r, AT, 0); \
+} while (0)
+
+#define emith_write16_r_r_r(r, rs, rm) do { \
+	emith_add_r_r_r_ptr(AT, rs, rm); \
+	emith_st_offs(F1_H, r, AT, 0); \
+} while (0)
+
 #define emith_ctx_read_ptr(r, offs) \
 	emith_read_r_r_offs_ptr(r, CONTEXT_REG, offs)
 
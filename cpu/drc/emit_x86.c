@@ -57,7 +57,7 @@ enum { xAX = 0, xCX, xDX, xBX, xSP, xBP, xSI, xDI,	// x86-64,i386 common
 #define DCOND_CC ICOND_JAE     // carry clear
 
 #define EMIT_PTR(ptr, val, type) \
-	*(type *)(ptr) = val
+	*(type *)TCACHE_RW(ptr) = val
 
 #define EMIT(val, type) do { \
 	EMIT_PTR(tcache_ptr, val, type); \
@@ -788,6 +788,17 @@ enum { xAX = 0, xCX, xDX, xBX, xSP, xBP, xSI, xDI,	// x86-64,i386 common
 	EMIT_OP_MODRM64(0x89, 0, r, 4); \
 	EMIT_SIB64(0, rs, rm); /* mov [rm + rs * 1], r */ \
 } while (0)
+#define emith_write8_r_r_r(r, rs, rm) do { \
+	EMIT_XREX8_IF(r, rm, rs); \
+	EMIT_OP_MODRM64(0x88, 0, r, 4); \
+	EMIT_SIB64(0, rs, rm); /* mov [rm + rs * 1], r */ \
+} while (0)
+#define emith_write16_r_r_r(r, rs, rm) do { \
+	EMIT(0x66, u8); \
+	EMIT_XREX_IF(0, r, rm, rs); \
+	EMIT_OP_MODRM64(0x89, 0, r, 4); \
+	EMIT_SIB64(0, rs, rm); /* mov [rm + rs * 1], r */ \
+} while (0)
 
 #define emith_ctx_read(r, offs) \
 	emith_read_r_r_offs(r, CONTEXT_REG, offs)
@@ -993,6 +1004,13 @@ enum { xAX = 0, xCX, xDX, xBX, xSP, xBP, xSI, xDI,	// x86-64,i386 common
 #define EMIT_REX_IF(w, r, rm) \
 	EMIT_XREX_IF(w, r, rm, 0)
 
+// byte access to sil, dil, spl, bpl needs a REX prefix
+#define EMIT_XREX8_IF(r, rm, rs) do { \
+	if ((r) >= 4 && (r) <= 7 && (rm) <= 7 && (rs) <= 7) \
+		EMIT_REX(0, 0, 0, 0); \
+	else	EMIT_XREX_IF(0, r, rm, rs); \
+} while (0)
+
 #ifndef _WIN32
 
 // SystemV ABI conventions:
@@ -1091,6 +1109,10 @@ enum { xAX = 0, xCX, xDX, xBX, xSP, xBP, xSI, xDI,	// x86-64,i386 common
 	assert((u32)(rs) < 8u); \
 	assert((u32)(rm) < 8u); \
 } while (0)
+#define EMIT_XREX8_IF(r, rs, rm) do { \
+	assert((u32)(r) < 4u); /* only al, cl, dl, bl */ \
+	EMIT_XREX_IF(0, r, rs, rm); \
+} while (0)
 
 // MS/SystemV ABI: ebx,esi,edi,ebp are preserved, eax,ecx,edx are temporaries
 // DRC uses REGPARM to pass upto 3 parameters in registers eax,ecx,edx.
@@ -43,13 +43,22 @@
 #define PROPAGATE_CONSTANTS     1
 #define LINK_BRANCHES           1
 #define BRANCH_CACHE            1
+#define JUMP_CACHE              1
 #define CALL_STACK              1
 #define ALIAS_REGISTERS         1
 #define REMAP_REGISTER          1
 #define LOOP_DETECTION          1
 #define LOOP_OPTIMIZER          1
+#define LIVE_RANGES             1
 #define T_OPTIMIZER             1
 #define DIV_OPTIMIZER           1
+#define FUSE_OPTIMIZER          1
+#define INLINE_SDRAM            1
+
+#if !BRANCH_CACHE // jump cache is refilled from the branch cache
+#undef  JUMP_CACHE
+#define JUMP_CACHE              0
+#endif
 
 #define MAX_LITERAL_OFFSET      0x200	// max. MOVA, MOV @(PC) offset
 #define MAX_LOCAL_TARGETS       (BLOCK_INSN_LIMIT / 4)
@@ -345,8 +354,10 @@ struct block_desc {
   int size;                  // ..of recompiled insns
   int size_lit;              // ..of (insns+)literal pool
   u8 *tcache_ptr;            // start address of block in cache
-  u16 crc;                   // crc of insns and literals
+  u32 crc;                   // checksum of insns and literals
   u16 active;                // actively used or deactivated?
+  u16 rom_data;              // has ROM data folded in as constants?
+  u64 rom_banks;             // ..ROM bank state it was folded with
   struct block_list *list;
 #if (DRC_DEBUG & 2)
   int refcount;
@@ -393,7 +404,10 @@ static struct block_link *blink_free[TCACHE_BUFFERS];
 #define RAM_SIZE(tcid) 			((tcid) ? 0x1000 : 0x40000)
 #define INVAL_PAGE_SIZE 0x100
 
-static struct block_list *inactive_blocks[TCACHE_BUFFERS];
+// disabled blocks, hashed by start address for fast reuse lookup
+#define INACTIVE_HASH_SIZE		256
+#define INACTIVE_HASH(addr)		(((addr) >> 1) & (INACTIVE_HASH_SIZE-1))
+static struct block_list *inactive_blocks[TCACHE_BUFFERS][INACTIVE_HASH_SIZE];
 
 // array of pointers to block_lists for RAM and 2 data arrays
 // each array has len: sizeof(mem) / INVAL_PAGE_SIZE 
@@ -521,6 +535,10 @@ static void REGPARM(1) (*sh2_drc_dispatcher)(u32 pc);
 static u32  REGPARM(2) (*sh2_drc_dispatcher_call)(u32 pc);
 static void REGPARM(1) (*sh2_drc_dispatcher_return)(u32 pc);
 #endif
+#if JUMP_CACHE
+static void REGPARM(2) (*sh2_drc_dispatcher_jump)(u32 pc, u32 offs);
+static int jump_cache_next; // next jump cache slot to hand out
+#endif
 static void REGPARM(1) (*sh2_drc_exit)(u32 pc);
 static void            (*sh2_drc_test_irq)(void);
 
@@ -858,12 +876,12 @@ static void dr_block_unlink(struct block_link *bl, int emit_jump)
         emith_jump_patch(jump, sh2_drc_dispatcher, &jump);
       } else if (bl->type == BL_LDJMP) { // restore: load pc, jump @dispatcher
         // inlined: @jump load target_pc, far jump to dispatcher
-        memcpy(jump, bl->jdisp, emith_jump_at_size());
+        memcpy(TCACHE_RW(jump), bl->jdisp, emith_jump_at_size());
         jsz = emith_jump_at_size();
       } else if (bl->type == BL_JCCBLX) { // jump cond @blx; @blx: load pc, jump
         // via blx: @jump near jumpcc to blx; @blx load target_pc, far jump
         emith_jump_patch(bl->jump, bl->blx, &jump);
-        memcpy(bl->blx, bl->jdisp, emith_jump_at_size());
+        memcpy(TCACHE_RW(bl->blx), bl->jdisp, emith_jump_at_size());
         host_instructions_updated(bl->blx, (char *)bl->blx + emith_jump_at_size(), 1);
       } else {
         printf("unknown BL type %d\n", bl->type);
@@ -1044,7 +1062,7 @@ static void dr_rm_block_entry(struct block_desc *bd, int tcache_id, u32 nolit, i
     }
 
     dr_mark_memory(-1, bd, tcache_id, nolit);
-    add_to_block_list(&inactive_blocks[tcache_id], bd);
+    add_to_block_list(&inactive_blocks[tcache_id][INACTIVE_HASH(bd->addr)], bd);
   }
   bd->active = 0;
 
@@ -1070,16 +1088,29 @@ static void dr_rm_block_entry(struct block_desc *bd, int tcache_id, u32 nolit, i
   emith_update_cache();
 }
 
-static struct block_desc *dr_find_inactive_block(int tcache_id, u16 crc,
+// current SH2 ROM bank state, for checking blocks with folded ROM data
+static u64 dr_rom_banks(void)
+{
+  u64 banks = 0;
+
+  if (carthw_ssf2_active)
+    memcpy(&banks, carthw_ssf2_banks, sizeof(banks));
+  return banks;
+}
+
+static struct block_desc *dr_find_inactive_block(int tcache_id, u32 crc,
   u32 addr, int size, u32 addr_lit, int size_lit)
 {
-  struct block_list **head = &inactive_blocks[tcache_id];
+  struct block_list **head = &inactive_blocks[tcache_id][INACTIVE_HASH(addr)];
   struct block_list *current;
+  u64 rom_banks = dr_rom_banks();
 
   for (current = *head; current != NULL; current = current->next) {
     struct block_desc *block = current->block;
+    // the crc doesn't cover folded ROM data, the banking must match for that
     if (block->crc == crc && block->addr == addr && block->size == size &&
-        block->addr_lit == addr_lit && block->size_lit == size_lit)
+        block->addr_lit == addr_lit && block->size_lit == size_lit &&
+        (!block->rom_data || block->rom_banks == rom_banks))
     {
       rm_from_block_lists(block);
       return block;
@@ -1089,7 +1120,7 @@ static struct block_desc *dr_find_inactive_block(int tcache_id, u16 crc,
 }
 
 static struct block_desc *dr_add_block(int entries, u32 addr, int size,
-  u32 addr_lit, int size_lit, u16 crc, int is_slave, int *blk_id)
+  u32 addr_lit, int size_lit, u32 crc, int is_slave, int *blk_id)
 {
   struct block_entry *be;
   struct block_desc *bd;
@@ -1117,6 +1148,8 @@ static struct block_desc *dr_add_block(int entries, u32 addr, int size,
   bd->tcache_ptr = tcache_ptr;
   bd->crc = crc;
   bd->active = 0;
+  bd->rom_data = 0;
+  bd->rom_banks = 0;
   bd->list = NULL;
   bd->entry_count = 0;
 #if (DRC_DEBUG & 2)
@@ -1259,6 +1292,14 @@ static u8 *dr_prepare_cache(int tcache_id, int insn_count, int entry_count)
       memset32(sh2s[1].branch_cache, -1, sizeof(sh2s[1].branch_cache)/4);
     }
 #endif
+#if JUMP_CACHE
+    if (tcache_id)
+      memset32(sh2s[tcache_id-1].jump_cache, -1, sizeof(sh2s[0].jump_cache)/4);
+    else {
+      memset32(sh2s[0].jump_cache, -1, sizeof(sh2s[0].jump_cache)/4);
+      memset32(sh2s[1].jump_cache, -1, sizeof(sh2s[1].jump_cache)/4);
+    }
+#endif
 #if CALL_STACK
     if (tcache_id) {
       memset32(sh2s[tcache_id-1].rts_cache, -1, sizeof(sh2s[0].rts_cache)/4);
@@ -1297,6 +1338,8 @@ static void dr_flush_tcache(int tcid)
     memset(Pico32xMem->drclit_ram, 0, sizeof(Pico32xMem->drclit_ram));
     memset(sh2s[0].branch_cache, -1, sizeof(sh2s[0].branch_cache));
     memset(sh2s[1].branch_cache, -1, sizeof(sh2s[1].branch_cache));
+    memset(sh2s[0].jump_cache, -1, sizeof(sh2s[0].jump_cache));
+    memset(sh2s[1].jump_cache, -1, sizeof(sh2s[1].jump_cache));
     memset(sh2s[0].rts_cache, -1, sizeof(sh2s[0].rts_cache));
     memset(sh2s[1].rts_cache, -1, sizeof(sh2s[1].rts_cache));
     sh2s[0].rts_cache_idx = sh2s[1].rts_cache_idx = 0;
@@ -1306,6 +1349,7 @@ static void dr_flush_tcache(int tcid)
     memset(Pico32xMem->drcblk_da[tcid - 1], 0, sizeof(Pico32xMem->drcblk_da[tcid - 1]));
     memset(Pico32xMem->drclit_da[tcid - 1], 0, sizeof(Pico32xMem->drclit_da[tcid - 1]));
     memset(sh2s[tcid - 1].branch_cache, -1, sizeof(sh2s[0].branch_cache));
+    memset(sh2s[tcid - 1].jump_cache, -1, sizeof(sh2s[0].jump_cache));
     memset(sh2s[tcid - 1].rts_cache, -1, sizeof(sh2s[0].rts_cache));
     sh2s[tcid - 1].rts_cache_idx = 0;
   }
@@ -1315,7 +1359,8 @@ static void dr_flush_tcache(int tcid)
 
   for (i = 0; i < RAM_SIZE(tcid) / INVAL_PAGE_SIZE; i++)
     discard_block_list(&inval_lookup[tcid][i]);
-  discard_block_list(&inactive_blocks[tcid]);
+  for (i = 0; i < INACTIVE_HASH_SIZE; i++)
+    discard_block_list(&inactive_blocks[tcid][i]);
 }
 
 static void *dr_failure(void)
@@ -2683,6 +2728,9 @@ static int emit_get_rbase_and_offs(SH2 *sh2, sh2_reg_e r, int rmode, s32 *offs)
 }
 
 // read const data from const ROM address
+// set if ROM data has been folded into the block being translated
+static int rom_data_folded;
+
 static int emit_get_rom_data(SH2 *sh2, sh2_reg_e r, s32 offs, int size, u32 *val)
 {
   u32 a, mask;
@@ -2697,6 +2745,7 @@ static int emit_get_rom_data(SH2 *sh2, sh2_reg_e r, s32 offs, int size, u32 *val
       case 1:   *val = (s16)p32x_sh2_read16(a, sh2s); break;  // 16
       case 2:   *val = p32x_sh2_read32(a, sh2s);      break;  // 32
       }
+      rom_data_folded = 1;
       return 1;
     }
   }
@@ -2766,10 +2815,24 @@ static void emit_sync_t_to_sr(void)
   }
 }
 
+#if INLINE_SDRAM
+// t = 0 if address a is in SDRAM (cached or cache-through)
+static void emit_sdram_check(int a, int t)
+{
+  emith_eor_r_r_imm(t, a, 0x06000000);
+  emith_bic_r_imm(t, 0x20000000);
+  emith_lsr(t, t, 18);
+  emith_tst_r_r(t, t);
+}
+#endif
+
 // rd = @(arg0)
 static int emit_memhandler_read(int size)
 {
   int hr;
+#if INLINE_SDRAM
+  int arg0, arg2, arg3;
+#endif
 
   emit_sync_t_to_sr();
   rcache_clean_tmp();
@@ -2786,12 +2849,34 @@ static int emit_memhandler_read(int size)
     case 1:   emith_call(sh2_drc_read16_poll);  break; // 16
     case 2:   emith_call(sh2_drc_read32_poll);  break; // 32
     }
-  else
+  else {
+#if INLINE_SDRAM
+    // SDRAM is plain memory, read it directly without calling out
+    host_arg2reg(arg0, 0);
+    host_arg2reg(arg2, 2);
+    host_arg2reg(arg3, 3);
+    emit_sdram_check(arg0, arg3);
+    EMITH_JMP3_START(DCOND_NE);
+    emith_ctx_read_ptr(arg2, offsetof(SH2, p_sdram));
+    emith_and_r_r_imm(arg0, arg0, 0x3ffff & ~((1 << (size & MF_SIZEMASK)) - 1));
+    switch (size & MF_SIZEMASK) {
+    case 0:   emit_le_ptr8(arg0);
+              emith_read8s_r_r_r(RET_REG, arg2, arg0);  break; // 8
+    case 1:   emith_read16s_r_r_r(RET_REG, arg2, arg0); break; // 16
+    case 2:   emith_read_r_r_r(RET_REG, arg2, arg0);
+              emit_le_swap(RET_REG);                    break; // 32
+    }
+    EMITH_JMP3_MID(DCOND_NE);
+#endif
     switch (size & MF_SIZEMASK) {
     case 0:   emith_call(sh2_drc_read8);        break; // 8
     case 1:   emith_call(sh2_drc_read16);       break; // 16
     case 2:   emith_call(sh2_drc_read32);       break; // 32
     }
+#if INLINE_SDRAM
+    EMITH_JMP3_END();
+#endif
+  }
 
   hr = rcache_get_tmp_ret();
   rcache_set_x16(hr, (size & MF_SIZEMASK) < 2, 0);
@@ -2801,6 +2886,11 @@ static int emit_memhandler_read(int size)
 // @(arg0) = arg1
 static void emit_memhandler_write(int size)
 {
+#if INLINE_SDRAM
+  int arg0, arg1, arg2, arg3;
+  u32 mask = 0x3ffff & ~((1 << (size & MF_SIZEMASK)) - 1);
+#endif
+
   emit_sync_t_to_sr();
   rcache_clean_tmp();
 #ifndef DRC_SR_REG
@@ -2809,11 +2899,44 @@ static void emit_memhandler_write(int size)
 #endif
   rcache_invalidate_tmp();
 
+#if INLINE_SDRAM
+  // SDRAM can be written directly unless it contains code or is polled,
+  // which is marked in the drcblk array (see sh2_write*_sdram)
+  host_arg2reg(arg0, 0);
+  host_arg2reg(arg1, 1);
+  host_arg2reg(arg2, 2);
+  host_arg2reg(arg3, 3);
+  emit_sdram_check(arg0, arg3);
+  EMITH_JMP_START(DCOND_NE);
+  emith_ctx_read_ptr(arg2, offsetof(SH2, p_drcblk_ram));
+  emith_and_r_r_imm(arg3, arg0, mask);
+  emith_lsr(arg3, arg3, SH2_DRCBLK_RAM_SHIFT);
+  if ((size & MF_SIZEMASK) == 2) // longword covers 2 drcblk entries
+    emith_read16_r_r_r(arg3, arg2, arg3);
+  else
+    emith_read8_r_r_r(arg3, arg2, arg3);
+  emith_tst_r_r(arg3, arg3);
+  EMITH_JMP_END(DCOND_NE);
+  EMITH_JMP3_START(DCOND_NE);
+  emith_ctx_read_ptr(arg2, offsetof(SH2, p_sdram));
+  emith_and_r_r_imm(arg0, arg0, mask);
+  switch (size & MF_SIZEMASK) {
+  case 0:   emit_le_ptr8(arg0);
+            emith_write8_r_r_r(arg1, arg2, arg0);  break;  // 8
+  case 1:   emith_write16_r_r_r(arg1, arg2, arg0); break;  // 16
+  case 2:   emit_le_swap(arg1);
+            emith_write_r_r_r(arg1, arg2, arg0);   break;  // 32
+  }
+  EMITH_JMP3_MID(DCOND_NE);
+#endif
   switch (size & MF_SIZEMASK) {
   case 0:   emith_call(sh2_drc_write8);     break;  // 8
   case 1:   emith_call(sh2_drc_write16);    break;  // 16
   case 2:   emith_call(sh2_drc_write32);    break;  // 32
   }
+#if INLINE_SDRAM
+  EMITH_JMP3_END();
+#endif
 }
 
 // rd = @(Rs,#offs); rd < 0 -> return a temp
@@ -2992,6 +3115,33 @@ static void emit_indirect_read_double(SH2 *sh2, int *rnr, int *rmr, sh2_reg_e rn
   *rnr = rcache_restore_tmp(tmp);
 }
  
+#if FUSE_OPTIMIZER
+// 64 bit product extraction after DMULS/DMULU, as used in fixed point math:
+//	STS MACH,Ra; STS MACL,Rb; XTRCT Ra,Rb	(STS in any order)
+// emitted in one go instead of aliasing and splitting the MAC regs again.
+// returns 1 if the sequence was found, 0 otherwise.
+static int emit_dmul_extract(u32 op1, u32 op2, u32 op3)
+{
+  int ra, rb, hr, hrl, hrh;
+
+  if ((op1 & 0xf0ef) != 0x000a || (op2 & 0xf0ef) != 0x000a ||
+      !((op1 ^ op2) & 0x10))
+    return 0;
+  ra = ((op1 & 0x10) ? op2 : op1) >> 8 & 0xf; // STS MACH,Ra
+  rb = ((op1 & 0x10) ? op1 : op2) >> 8 & 0xf; // STS MACL,Rb
+  if (ra == rb || op3 != (0x200d | (rb << 8) | (ra << 4)))
+    return 0;
+
+  emit_move_r_r(ra, SHR_MACH);
+  hrl = rcache_get_reg(SHR_MACL, RC_GR_READ, NULL);
+  hrh = rcache_get_reg(SHR_MACH, RC_GR_READ, NULL);
+  hr  = rcache_get_reg(rb, RC_GR_WRITE, NULL);
+  emith_lsr(hr, hrl, 16);
+  emith_or_r_r_lsl(hr, hrh, 16);
+  return 1;
+}
+#endif
+
 static void emit_do_static_regs(int is_write, int tmpr)
 {
   int i, r, count;
@@ -3260,6 +3410,15 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
   int blx_target_count = 0;
 
   static u8 op_flags[BLOCK_INSN_LIMIT];
+#if LIVE_RANGES
+  // register live ranges up to the next rcache flush, for the reg allocator
+  static struct {
+    u32 live;  // regs read by later insns before being overwritten
+    u32 dead;  // regs overwritten by later insns before being read
+    u32 hot;   // live regs read often enough to keep them in host regs
+  } op_regs[BLOCK_INSN_LIMIT];
+  u8 reg_uses[32];
+#endif
 
   enum flg_states { FLG_UNKNOWN, FLG_UNUSED, FLG_0, FLG_1 };
   struct drcf {
@@ -3296,7 +3455,7 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
   int i, v;
   u32 u, m1, m2, m3, m4;
   int op;
-  u16 crc;
+  u32 crc;
 
   base_pc = sh2->pc;
 
@@ -3329,6 +3488,8 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
     dbg(2, "== %csh2 reuse block %08x-%08x,%08x-%08x -> %p", sh2->is_slave ? 's' : 'm',
       base_pc, end_pc, base_literals, end_literals, block->entryp->tcache_ptr);
     dr_activate_block(block, tcache_id, sh2->is_slave);
+    if ((base_pc & 0xc6000000) == 0x02000000 || block->rom_data) // ROM
+      Pico32x.emu_flags |= P32XF_DRC_ROM_C;
     emith_update_cache();
     return block->entryp[0].tcache_ptr;
   }
@@ -3336,6 +3497,10 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
   // collect branch_targets that don't land on delay slots
   m1 = m2 = m3 = m4 = v = op = 0;
   for (pc = base_pc, i = 0; pc < end_pc; i++, pc += 2) {
+#ifdef PDB
+    if (pdb_bpt_at(pc))
+      op_flags[i] |= OF_BTARGET; // needs a block entry to call the debugger
+#endif
     if (op_flags[i] & OF_DELAY_OP)
       op_flags[i] &= ~OF_BTARGET;
     if (op_flags[i] & OF_BTARGET) {
@@ -3427,6 +3592,33 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
 #endif
   }
 
+#if LIVE_RANGES
+  // backward pass over the block to get live ranges for the reg allocator.
+  // The cache is flushed at branch targets and after branches, hence ranges
+  // end there. Regs often read inside a range are marked as hot and kept in
+  // host regs for the whole range on hosts having enough of them.
+  u = m1 = m2 = 0;
+  memset(reg_uses, 0, sizeof(reg_uses));
+  for (i = (end_pc - base_pc) / 2 - 1; i >= 0; i--) {
+    op_regs[i].live = m1;
+    op_regs[i].dead = m2;
+    op_regs[i].hot = u & m1;
+    if ((op_flags[i] & OF_BTARGET) || (i > 0 && (op_flags[i-1] & OF_DELAY_OP))
+        || (i > 0 && OP_ISBRACND(ops[i-1].op) && !(op_flags[i] & OF_DELAY_OP))) {
+      // range ends before insn i
+      u = m1 = m2 = 0;
+      memset(reg_uses, 0, sizeof(reg_uses));
+      continue;
+    }
+    m1 = (m1 & ~ops[i].dest) | ops[i].source;
+    m2 = (m2 & ~ops[i].source) | (ops[i].dest & ~ops[i].source);
+    FOR_ALL_BITS_SET_DO(ops[i].source & ~rcache_regs_static &
+        ~BITMASK5(SHR_PC, SHR_PR, SHR_SR, SHR_T, SHR_MEM), v,
+        if (++reg_uses[v] == 3 && count_bits(u) < count_bits(rcache_vregs_reg)/2)
+          u |= (1 << v));
+  }
+#endif
+
   tcache_ptr = dr_prepare_cache(tcache_id, (end_pc - base_pc) / 2, branch_target_count);
 #if (DRC_DEBUG & 4)
   tcache_dsm_ptrs[tcache_id] = tcache_ptr;
@@ -3438,6 +3630,7 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
     return NULL;
 
   block_entry_ptr = tcache_ptr;
+  rom_data_folded = 0;
   dbg(2, "== %csh2 block #%d,%d %08x-%08x,%08x-%08x -> %p", sh2->is_slave ? 's' : 'm',
     tcache_id, blkid_main, base_pc, end_pc, base_literals, end_literals, block_entry_ptr);
 
@@ -3451,6 +3644,14 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
   pinned_loop_count = 0;
 #endif
 
+#if FUSE_OPTIMIZER
+  // the n-th insn after the current one can be merged into it if it's in the
+  // same rcache range. NB pc already points to the insn after the current one
+#define FUSE_OK(n) \
+  (!(op_flags[i] & OF_DELAY_OP) && pc + 2*((n)-1) < end_pc && \
+   !(op_flags[i+(n)] & (OF_BTARGET|OF_DELAY_OP)))
+#endif
+
   // -------------------------------------------------
   // 3rd pass: actual compilation
   pc = base_pc;
@@ -3594,24 +3795,27 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
       rcache_free_tmp(tmp2);
 #endif
 
-#if (DRC_DEBUG & (8|256|512|1024))
-      sr = rcache_get_reg(SHR_SR, RC_GR_RMW, NULL);
-      emith_sync_t(sr);
-      rcache_clean();
-      tmp = rcache_used_hregs_mask();
-      emith_save_caller_regs(tmp);
-      emit_do_static_regs(1, 0);
-      rcache_get_reg_arg(2, SHR_SR, NULL);
-      tmp2 = rcache_get_tmp_arg(0);
-      tmp3 = rcache_get_tmp_arg(1);
-      tmp4 = rcache_get_tmp();
-      emith_move_r_ptr_imm(tmp2, tcache_ptr);
-      emith_move_r_r_ptr(tmp3, CONTEXT_REG);
-      emith_move_r_imm(tmp4, pc);
-      emith_ctx_write(tmp4, SHR_PC * 4);
-      rcache_invalidate_tmp();
-      emith_abicall(sh2_drc_log_entry);
-      emith_restore_caller_regs(tmp);
+#if (DRC_DEBUG & (8|256|512|1024)) || defined(PDB)
+      // with PDB, only where the debugger wants it (usually breakpoints)
+      if ((DRC_DEBUG & (8|256|512|1024)) || pdb_bpt_check(pc)) {
+        sr = rcache_get_reg(SHR_SR, RC_GR_RMW, NULL);
+        emith_sync_t(sr);
+        rcache_clean();
+        tmp = rcache_used_hregs_mask();
+        emith_save_caller_regs(tmp);
+        emit_do_static_regs(1, 0);
+        rcache_get_reg_arg(2, SHR_SR, NULL);
+        tmp2 = rcache_get_tmp_arg(0);
+        tmp3 = rcache_get_tmp_arg(1);
+        tmp4 = rcache_get_tmp();
+        emith_move_r_ptr_imm(tmp2, tcache_ptr);
+        emith_move_r_r_ptr(tmp3, CONTEXT_REG);
+        emith_move_r_imm(tmp4, pc);
+        emith_ctx_write(tmp4, SHR_PC * 4);
+        rcache_invalidate_tmp();
+        emith_abicall(sh2_drc_log_entry);
+        emith_restore_caller_regs(tmp);
+      }
 #endif
 
       do_host_disasm(tcache_id);
@@ -3742,6 +3946,12 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
       } else
         break;
     }
+#if LIVE_RANGES
+    // extend the lookahead to the whole live range, and keep hot regs around
+    soon |= op_regs[i].hot;
+    late |= op_regs[i].live;
+    write |= op_regs[i].dead;
+#endif
     rcache_set_usage_now(opd[0].source);   // current insn
     rcache_set_usage_soon(soon);           // insns 1-4
     rcache_set_usage_late(late & ~soon);   // insns 5-9
@@ -4322,6 +4532,13 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
         tmp3 = rcache_get_reg(SHR_MACL, RC_GR_WRITE, NULL);
         tmp4 = rcache_get_reg(SHR_MACH, RC_GR_WRITE, NULL);
         emith_mul_u64(tmp3, tmp4, tmp, tmp2);
+#if FUSE_OPTIMIZER
+        if (FUSE_OK(1) && FUSE_OK(2) && FUSE_OK(3) &&
+            emit_dmul_extract(FETCH_OP(pc), FETCH_OP(pc+2), FETCH_OP(pc+4))) {
+          cycles += ops[i+1].cycles + ops[i+2].cycles + ops[i+3].cycles;
+          skip_op = 3;
+        }
+#endif
         goto end_op;
       case 0x08: // SUB     Rm,Rn       0011nnnnmmmm1000
 #if PROPAGATE_CONSTANTS
@@ -4397,6 +4614,13 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
         tmp3 = rcache_get_reg(SHR_MACL, RC_GR_WRITE, NULL);
         tmp4 = rcache_get_reg(SHR_MACH, RC_GR_WRITE, NULL);
         emith_mul_s64(tmp3, tmp4, tmp, tmp2);
+#if FUSE_OPTIMIZER
+        if (FUSE_OK(1) && FUSE_OK(2) && FUSE_OK(3) &&
+            emit_dmul_extract(FETCH_OP(pc), FETCH_OP(pc+2), FETCH_OP(pc+4))) {
+          cycles += ops[i+1].cycles + ops[i+2].cycles + ops[i+3].cycles;
+          skip_op = 3;
+        }
+#endif
         goto end_op;
       }
       goto default_;
@@ -4619,6 +4843,20 @@ static void REGPARM(2) *sh2_translate(SH2 *sh2, int tcache_id)
         default:
           goto default_;
         }
+#if FUSE_OPTIMIZER
+        // merge following shifts of Rn in the same direction
+        for (tmp4 = 1; FUSE_OK(tmp4); tmp4++) {
+          u = FETCH_OP(pc + 2*(tmp4-1));
+          if ((u & 0xff0f) != (op & 0xff0f) || (u & 0xf0) > 0x20)
+            break;
+          tmp2 = (u & 0x20 ? 16 : u & 0x10 ? 8 : 2);
+          if (tmp + tmp2 >= 32)
+            break;
+          tmp += tmp2;
+          cycles += ops[i+tmp4].cycles;
+          skip_op++;
+        }
+#endif
         tmp2 = rcache_get_reg(GET_Rn(), RC_GR_RMW, &tmp3);
         if (op & 1) {
           emith_lsr(tmp2, tmp3, tmp);
@@ -5172,7 +5410,22 @@ end_op:
         emith_jump_patchable(sh2_drc_dispatcher);
       } else {
         // JMP, JSR, BRAF, BSRF not const
+#if JUMP_CACHE
+        // check the jump cache slot of this site before calling the dispatcher
+        u32 offs = (jump_cache_next++ % ARRAY_SIZE(sh2s->jump_cache)) * 2*sizeof(void *);
+        host_arg2reg(tmp, 0); // may have been reused for the rts data above
+        tmp2 = rcache_get_tmp_arg(1);
+        emith_ctx_read(tmp2, offsetof(SH2, jump_cache) + offs);
+        emith_cmp_r_r(tmp2, tmp);
+        EMITH_SJMP_START(DCOND_NE);
+        emith_ctx_read_ptr(tmp2, offsetof(SH2, jump_cache) + offs + sizeof(void *));
+        emith_jump_reg(tmp2);
+        EMITH_SJMP_END(DCOND_NE);
+        emith_move_r_imm(tmp2, offs);
+        emith_jump(sh2_drc_dispatcher_jump);
+#else
         emith_jump(sh2_drc_dispatcher);
+#endif
       }
       rcache_invalidate();
 
@@ -5231,6 +5484,10 @@ end_op:
   ring_alloc(&tcache_ring[tcache_id], tcache_ptr - block_entry_ptr);
   host_instructions_updated(block_entry_ptr, tcache_ptr, 1);
 
+  if (rom_data_folded) {
+    block->rom_data = 1;
+    block->rom_banks = dr_rom_banks();
+  }
   dr_activate_block(block, tcache_id, sh2->is_slave);
   emith_update_cache();
 
@@ -5244,6 +5501,8 @@ end_op:
     dbg(2, "  hash collisions %d/%d", hash_collisions, block_ring[tcache_id].used);
     Pico32x.emu_flags |= P32XF_DRC_ROM_C;
   }
+  if (block->rom_data)
+    Pico32x.emu_flags |= P32XF_DRC_ROM_C;
 /*
  printf("~~~\n");
  tcache_dsm_ptrs[tcache_id] = block_entry_ptr;
@@ -5488,6 +5747,23 @@ static void sh2_generate_utils(void)
   emith_flush();
 #endif
 
+#if JUMP_CACHE
+  // sh2_drc_dispatcher_jump(u32 pc, u32 offs)
+  // refill jump cache slot at offs from the branch cache, else dispatch
+  sh2_drc_dispatcher_jump = (void *)tcache_ptr;
+  emith_and_r_r_imm(arg2, arg0, (ARRAY_SIZE(sh2s->branch_cache)-1)*8);
+  emith_add_r_r_r_lsl_ptr(arg2, CONTEXT_REG, arg2, sizeof(void *) == 8 ? 1 : 0);
+  emith_read_r_r_offs(arg3, arg2, offsetof(SH2, branch_cache));
+  emith_cmp_r_r(arg3, arg0);
+  emith_jump_cond(DCOND_NE, sh2_drc_dispatcher);
+  emith_add_r_r_r_lsl_ptr(arg1, CONTEXT_REG, arg1, 0);
+  emith_write_r_r_offs(arg0, arg1, offsetof(SH2, jump_cache));
+  emith_read_r_r_offs_ptr(RET_REG, arg2, offsetof(SH2, branch_cache) + sizeof(void *));
+  emith_write_r_r_offs_ptr(RET_REG, arg1, offsetof(SH2, jump_cache) + sizeof(void *));
+  emith_jump_reg(RET_REG);
+  emith_flush();
+#endif
+
   // sh2_drc_test_irq(void)
   // assumes it's called from main function (may jump to dispatcher)
   sh2_drc_test_irq = (void *)tcache_ptr;
@@ -5565,11 +5841,11 @@ static void sh2_generate_utils(void)
   emith_flush();
 #endif
 
-#ifdef PDB_NET
+#if defined(PDB_NET) || defined(PDB_TRACE)
   // debug
   #define MAKE_READ_WRAPPER(func) { \
     void *tmp = (void *)tcache_ptr; \
-    emith_push_ret(); \
+    emith_push_ret(-1); \
     emith_call(func); \
     emith_ctx_read(arg2, offsetof(SH2, pdb_io_csum[0]));  \
     emith_addf_r_r(arg2, arg0);                           \
@@ -5577,7 +5853,7 @@ static void sh2_generate_utils(void)
     emith_ctx_read(arg2, offsetof(SH2, pdb_io_csum[1]));  \
     emith_adc_r_imm(arg2, 0x01000000);                    \
     emith_ctx_write(arg2, offsetof(SH2, pdb_io_csum[1])); \
-    emith_pop_and_ret(); \
+    emith_pop_and_ret(-1); \
     emith_flush(); \
     func = tmp; \
   }
@@ -5614,6 +5890,9 @@ static void sh2_generate_utils(void)
 #if CALL_STACK
   host_dasm_new_symbol(sh2_drc_dispatcher_call);
   host_dasm_new_symbol(sh2_drc_dispatcher_return);
+#endif
+#if JUMP_CACHE
+  host_dasm_new_symbol(sh2_drc_dispatcher_jump);
 #endif
   host_dasm_new_symbol(sh2_drc_exit);
   host_dasm_new_symbol(sh2_drc_test_irq);
@@ -5690,6 +5969,14 @@ static void sh2_smc_rm_blocks(u32 a, int len, int tcache_id, int free)
     memset32(sh2s[1].branch_cache, -1, sizeof(sh2s[1].branch_cache)/4);
   }
 #endif
+#if JUMP_CACHE
+  if (tcache_id)
+    memset32(sh2s[tcache_id-1].jump_cache, -1, sizeof(sh2s[0].jump_cache)/4);
+  else {
+    memset32(sh2s[0].jump_cache, -1, sizeof(sh2s[0].jump_cache)/4);
+    memset32(sh2s[1].jump_cache, -1, sizeof(sh2s[1].jump_cache)/4);
+  }
+#endif
 #if CALL_STACK
   if (tcache_id) {
     memset32(sh2s[tcache_id-1].rts_cache, -1, sizeof(sh2s[0].rts_cache)/4);
@@ -5724,6 +6011,11 @@ int sh2_execute_drc(SH2 *sh2c, int cycles)
 #if (DRC_DEBUG & 8)
   lastpc = lastcnt = 0;
 #endif
+#ifdef PDB
+  // breakpoints or debugger mode changed, retranslate with new entry hooks
+  if (pdb_recompile_pending())
+    sh2_drc_flush_all();
+#endif
 
   sh2c->state |= SH2_IN_DRC;
   host_call(sh2_drc_entry, (SH2 *))(sh2c);
@@ -5916,6 +6208,58 @@ void sh2_drc_flush_all(void)
   Pico32x.emu_flags &= ~P32XF_DRC_ROM_C;
 }
 
+// disable all blocks, or those using ROM contents only. A disabled block is reused
+// without recompiling on the next lookup if its checksum still matches.
+static void dr_disable_blocks(int rom_only)
+{
+  struct block_desc *bd;
+  int i, t;
+
+  if (block_tables[0] == NULL)
+    return;
+
+  // blocks in SDRAM or data arrays may have folded ROM data too
+  for (t = 0; t < TCACHE_BUFFERS; t++) {
+    for (i = 0; i < block_ring[t].used; i++) {
+      bd = &block_tables[t][(block_ring[t].first + i) % block_ring[t].size];
+      if (bd->addr == 0 || bd->entry_count == 0 || !bd->active)
+        continue;
+      if (!rom_only || (bd->addr & 0xc6000000) == 0x02000000 || bd->rom_data)
+        dr_rm_block_entry(bd, t, 0, 0);
+    }
+  }
+  // no active ROM blocks left, reusing one sets this again
+  Pico32x.emu_flags &= ~P32XF_DRC_ROM_C;
+
+  for (i = 0; i < ARRAY_SIZE(sh2s); i++) {
+#if BRANCH_CACHE
+    memset32(sh2s[i].branch_cache, -1, sizeof(sh2s[i].branch_cache)/4);
+#endif
+#if JUMP_CACHE
+    memset32(sh2s[i].jump_cache, -1, sizeof(sh2s[i].jump_cache)/4);
+#endif
+#if CALL_STACK
+    memset32(sh2s[i].rts_cache, -1, sizeof(sh2s[i].rts_cache)/4);
+    sh2s[i].rts_cache_idx = 0;
+#endif
+  }
+}
+
+// after a state load memory may contain anything. Disable all blocks instead
+// of flushing the whole cache, unchanged code is then reused. Blocks with
+// folded ROM data are only reused if the restored ROM banks are the same
+void sh2_drc_state_loaded(void)
+{
+  dr_disable_blocks(0);
+}
+
+// ROM bank switch. Blocks of the old bank are kept and reused if it's
+// switched back in later
+void sh2_drc_rom_banked(void)
+{
+  dr_disable_blocks(1);
+}
+
 void sh2_drc_mem_setup(SH2 *sh2)
 {
   // fill the DRC-only convenience pointers
@@ -5995,6 +6339,7 @@ int sh2_drc_init(SH2 *sh2)
 #endif
   }
   memset(sh2->branch_cache, -1, sizeof(sh2->branch_cache));
+  memset(sh2->jump_cache, -1, sizeof(sh2->jump_cache));
   memset(sh2->rts_cache, -1, sizeof(sh2->rts_cache));
   sh2->rts_cache_idx = 0;
 
@@ -6091,7 +6436,10 @@ static void *dr_get_pc_base(u32 pc, SH2 *sh2)
   return (char *)ret - (pc & ~mask);
 }
 
-u16 scan_block(u32 base_pc, int is_slave, u8 *op_flags, u32 *end_pc_out,
+// rotate-xor checksum, unlike a plain sum it also detects reordered insns
+#define DRC_CRC(crc, op)  (((crc) << 5 | (crc) >> 27) ^ (op))
+
+u32 scan_block(u32 base_pc, int is_slave, u8 *op_flags, u32 *end_pc_out,
   u32 *base_literals_out, u32 *end_literals_out)
 {
   u16 *dr_pc_base;
@@ -6953,7 +7301,7 @@ end:
   i_div = -1; // index of current divide op
   for (i = 0, pc = base_pc; i < i_end; i++, pc += 2) {
     opd = &ops[i];
-    crc += FETCH_OP(pc);
+    crc = DRC_CRC(crc, FETCH_OP(pc));
 
     // propagate T (TODO: DIV0U)
     if (op_flags[i] & OF_BTARGET)
@@ -7084,7 +7432,7 @@ end:
 
   if (lowest_literal && end_literals)
     for (pc = lowest_literal; pc < end_literals; pc += 2)
-      crc += FETCH_OP(pc);
+      crc = DRC_CRC(crc, FETCH_OP(pc));
 
   *end_pc_out = end_pc;
   if (base_literals_out != NULL)
@@ -7092,9 +7440,6 @@ end:
   if (end_literals_out != NULL)
     *end_literals_out = (end_literals ? end_literals : end_pc);
 
-  // crc overflow handling, twice to collect all overflows
-  crc = (crc & 0xffff) + (crc >> 16);
-  crc = (crc & 0xffff) + (crc >> 16);
   return crc;
 }
 
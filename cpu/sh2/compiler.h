@@ -6,9 +6,13 @@ void sh2_drc_wcheck_da(u32 a, unsigned len, SH2 *sh2);
 #ifdef DRC_SH2
 void sh2_drc_mem_setup(SH2 *sh2);
 void sh2_drc_flush_all(void);
+void sh2_drc_state_loaded(void);
+void sh2_drc_rom_banked(void);
 #else
 #define sh2_drc_mem_setup(x)
 #define sh2_drc_flush_all()
+#define sh2_drc_state_loaded()
+#define sh2_drc_rom_banked()
 #define sh2_drc_frame()
 #endif
 
@@ -27,7 +31,7 @@ void sh2_drc_flush_all(void);
 #define OF_DELAY_LOOP (2 << 2)
 #define OF_POLL_LOOP  (3 << 2)
 
-u16 scan_block(u32 base_pc, int is_slave, u8 *op_flags, u32 *end_pc,
+u32 scan_block(u32 base_pc, int is_slave, u8 *op_flags, u32 *end_pc,
 		u32 *base_literals, u32 *end_literals);
 
 #if defined(DRC_SH2) && defined(__GNUC__) && !defined(__clang__)
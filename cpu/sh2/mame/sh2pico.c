@@ -109,8 +109,41 @@ static unsigned int op_refs[0x10000];
 
 #ifndef DRC_CMP
 
+// opcode fetch directly from memory mapped without handlers. The area is
+// looked up once per timeslice instead of going through RW() for every insn.
+// DRAM is left out since the SH2 may swap it, the BIOS since its handler
+// accounts for wait states
+struct fetch_area {
+	const UINT8 *base;
+	UINT32 start, size;
+};
+
+static void fetch_area_lookup(SH2 *sh2, UINT32 a, struct fetch_area *fa)
+{
+	u32 mask;
+	UINT8 *p = p32x_sh2_get_mem_ptr(a, &mask, sh2);
+
+	fa->start = a, fa->size = 0;
+	if (p == (void *)-1 || (a & ~0x7ff) == 0 || (a & 0xc6000000) == 0x04000000)
+		return;
+	fa->base = p;
+	fa->start = a & ~mask;
+	fa->size = mask + 1;
+}
+
+static __inline UINT32 fetch_op(SH2 *sh2, UINT32 a, struct fetch_area *fa)
+{
+	if (a - fa->start >= fa->size) {
+		fetch_area_lookup(sh2, a, fa);
+		if (fa->size == 0)
+			return (UINT16)RW(sh2, a);
+	}
+	return *(const UINT16 *)(fa->base + (a - fa->start));
+}
+
 int sh2_execute_interpreter(SH2 *sh2, int cycles)
 {
+	struct fetch_area fa = { NULL, 0, 0 };
 	UINT32 opcode;
 
 	sh2->icount = cycles;
@@ -123,7 +156,7 @@ int sh2_execute_interpreter(SH2 *sh2, int cycles)
 		if (sh2->delay)
 		{
 			sh2->ppc = sh2->delay;
-			opcode = (UINT32)(UINT16)RW(sh2, sh2->delay);
+			opcode = fetch_op(sh2, sh2->delay, &fa);
 
 			// TODO: more branch types
 			if ((opcode >> 13) == 5) { // BRA/BSR
@@ -141,7 +174,7 @@ int sh2_execute_interpreter(SH2 *sh2, int cycles)
 		else
 		{
 			sh2->ppc = sh2->pc;
-			opcode = (UINT32)(UINT16)RW(sh2, sh2->pc);
+			opcode = fetch_op(sh2, sh2->pc, &fa);
 		}
 
 		sh2->delay = 0;
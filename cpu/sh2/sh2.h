@@ -63,6 +63,8 @@ typedef struct SH2_
 	int rts_cache_idx;
 	struct { uint32_t pc; void *code; } rts_cache[16];
 	struct { uint32_t pc; void *code; } branch_cache[128];
+	// DRC jump cache for indirect jumps, one slot per jump site
+	struct { uint32_t pc; void *code; } jump_cache[64];
 
 	// interpreter stuff
 	int		icount;		// cycles left in current timeslice
@@ -139,6 +141,7 @@ u32 REGPARM(2) p32x_sh2_read32(u32 a, SH2 *sh2);
 void REGPARM(3) p32x_sh2_write8 (u32 a, u32 d, SH2 *sh2);
 void REGPARM(3) p32x_sh2_write16(u32 a, u32 d, SH2 *sh2);
 void REGPARM(3) p32x_sh2_write32(u32 a, u32 d, SH2 *sh2);
+void *p32x_sh2_get_mem_ptr(u32 a, u32 *mask, SH2 *sh2);
 
 // debug
 #ifdef DRC_CMP
@@ -13,6 +13,10 @@
 struct Pico32x Pico32x;
 SH2 sh2s[2];
 
+/* times are in m68k (7.6MHz) cycles */
+unsigned int p32x_event_times[P32X_EVENT_COUNT];
+static struct pico_events p32x_events = { p32x_event_times, P32X_EVENT_COUNT };
+
 #define SH2_IDLE_STATES (SH2_STATE_CPOLL|SH2_STATE_VPOLL|SH2_STATE_RPOLL|SH2_STATE_SLEEP)
 
 static int REGPARM(2) sh2_irq_cb(SH2 *sh2, int level)
@@ -219,6 +223,7 @@ void PicoPower32x(void)
 {
   memset(&Pico32x, 0, sizeof(Pico32x));
   memset(p32x_event_times, 0, sizeof(p32x_event_times));
+  pico_events_rebuild(&p32x_events);
 
   Pico32x.regs[0] = P32XS_REN|P32XS_nRES; // verified
   Pico32x.regs[0x10/2] = 0xffff;
@@ -390,9 +395,6 @@ static void stimer_event(unsigned int now)
 
 typedef void (event_cb)(unsigned int now);
 
-/* times are in m68k (7.6MHz) cycles */
-unsigned int p32x_event_times[P32X_EVENT_COUNT];
-static unsigned int event_time_next;
 static event_cb *p32x_event_cbs[P32X_EVENT_COUNT] = {
   p32x_pwm_irq_event, // P32X_EVENT_PWM
   fillend_event,      // P32X_EVENT_FILLEND
@@ -409,10 +411,7 @@ void p32x_event_schedule(unsigned int now, enum p32x_event event, int after)
   when = (now + after) | 1;
 
   elprintf(EL_32X, "32x: new event #%u %u->%u", event, now, when);
-  p32x_event_times[event] = when;
-
-  if (event_time_next == 0 || CYCLES_GT(event_time_next, when))
-    event_time_next = when;
+  pico_event_set(&p32x_events, event, when);
 }
 
 void p32x_event_schedule_sh2(SH2 *sh2, enum p32x_event event, int after)
@@ -425,7 +424,7 @@ void p32x_event_schedule_sh2(SH2 *sh2, enum p32x_event event, int after)
 
   p32x_event_schedule(now, event, after);
 
-  left_to_next = C_M68K_TO_SH2(sh2, (int)(event_time_next - now));
+  left_to_next = C_M68K_TO_SH2(sh2, (int)(p32x_events.next - now));
   if (sh2_cycles_left(sh2) > left_to_next) {
     if (left_to_next < 1)
       left_to_next = 0;
@@ -435,41 +434,16 @@ void p32x_event_schedule_sh2(SH2 *sh2, enum p32x_event event, int after)
 
 static void p32x_run_events(unsigned int until)
 {
-  int oldest, oldest_diff, time;
-  int i, diff;
-
-  while (1) {
-    oldest = -1, oldest_diff = 0x7fffffff;
+  unsigned int time;
+  int event;
 
-    for (i = 0; i < P32X_EVENT_COUNT; i++) {
-      if (p32x_event_times[i]) {
-        diff = p32x_event_times[i] - until;
-        if (diff < oldest_diff) {
-          oldest_diff = diff;
-          oldest = i;
-        }
-      }
-    }
-
-    if (oldest_diff <= 0) {
-      time = p32x_event_times[oldest];
-      p32x_event_times[oldest] = 0;
-      elprintf(EL_32X, "32x: run event #%d %u", oldest, time);
-      p32x_event_cbs[oldest](time);
-    }
-    else if (oldest_diff < 0x7fffffff) {
-      event_time_next = p32x_event_times[oldest];
-      break;
-    }
-    else {
-      event_time_next = 0;
-      break;
-    }
+  while ((event = pico_event_pop(&p32x_events, until, &time)) >= 0) {
+    elprintf(EL_32X, "32x: run event #%d %u", event, time);
+    p32x_event_cbs[event](time);
   }
 
-  if (oldest != -1)
-    elprintf(EL_32X, "32x: next event #%d at %u",
-      oldest, event_time_next);
+  if (p32x_events.next)
+    elprintf(EL_32X, "32x: next event at %u", p32x_events.next);
 }
 
 static void run_sh2(SH2 *sh2, unsigned int m68k_cycles)
@@ -519,8 +493,8 @@ void p32x_sync_other_sh2(SH2 *sh2, unsigned int m68k_target)
   run_sh2(osh2, m68k_cycles);
 
   // there might be new event to schedule current sh2 to
-  if (event_time_next) {
-    left_to_event = C_M68K_TO_SH2(sh2, (int)(event_time_next - m68k_target));
+  if (p32x_events.next) {
+    left_to_event = C_M68K_TO_SH2(sh2, (int)(p32x_events.next - m68k_target));
     if (sh2_cycles_left(sh2) > left_to_event) {
       if (left_to_event < 1)
         left_to_event = 0;
@@ -555,12 +529,12 @@ void sync_sh2s_normal(unsigned int m68k_target)
   pprof_start(m68k);
   while (CYCLES_GT(m68k_target, now))
   {
-    if (event_time_next && CYCLES_GE(now, event_time_next))
+    if (p32x_events.next && CYCLES_GE(now, p32x_events.next))
       p32x_run_events(now);
 
     target = m68k_target;
-    if (event_time_next && CYCLES_GT(target, event_time_next))
-      target = event_time_next;
+    if (p32x_events.next && CYCLES_GT(target, p32x_events.next))
+      target = p32x_events.next;
     while (CYCLES_GT(target, now))
     {
       next = target;
@@ -576,8 +550,8 @@ void sync_sh2s_normal(unsigned int m68k_target)
         if (cycles > 0) {
           run_sh2(&ssh2, cycles > 20U ? cycles : 20U);
 
-          if (event_time_next && CYCLES_GT(target, event_time_next))
-            target = event_time_next;
+          if (p32x_events.next && CYCLES_GT(target, p32x_events.next))
+            target = p32x_events.next;
           if (CYCLES_GT(next, target))
             next = target;
         }
@@ -590,8 +564,8 @@ void sync_sh2s_normal(unsigned int m68k_target)
         if (cycles > 0) {
           run_sh2(&msh2, cycles > 20U ? cycles : 20U);
 
-          if (event_time_next && CYCLES_GT(target, event_time_next))
-            target = event_time_next;
+          if (p32x_events.next && CYCLES_GT(target, p32x_events.next))
+            target = p32x_events.next;
           if (CYCLES_GT(next, target))
             next = target;
         }
@@ -694,6 +668,7 @@ void Pico32xStateLoaded(int is_early)
     return;
   }
 
+  pico_events_rebuild(&p32x_events);
   if (CYCLES_GE(sh2s[0].m68krcycles_done - Pico.t.m68c_aim, 500) ||
       CYCLES_GE(sh2s[1].m68krcycles_done - Pico.t.m68c_aim, 500))
     sh2s[0].m68krcycles_done = sh2s[1].m68krcycles_done = Pico.t.m68c_aim;
@@ -1131,9 +1131,15 @@ static void PicoWrite8_32x_on_io_cd(u32 a, u32 d)
 
 static void PicoWrite8_32x_on_io_ssf2(u32 a, u32 d)
 {
+  u8 bank = carthw_ssf2_banks[(a >> 1) & 7];
+
   carthw_ssf2_write8(a, d);
-  if ((a & ~0x0e) == 0xa130f1)
-    bank_switch_rom_68k(Pico32x.regs[4 / 2]);
+  if ((a & ~0x0e) == 0xa130f1) {
+    if (carthw_ssf2_banks[(a >> 1) & 7] != bank)
+      p32x_update_banks(); // SH2 sees the new bank too
+    else
+      bank_switch_rom_68k(Pico32x.regs[4 / 2]);
+  }
 }
 
 static void PicoWrite16_32x_on(u32 a, u32 d)
@@ -1185,9 +1191,15 @@ static void PicoWrite16_32x_on_io_cd(u32 a, u32 d)
 
 static void PicoWrite16_32x_on_io_ssf2(u32 a, u32 d)
 {
+  u8 bank = carthw_ssf2_banks[(a >> 1) & 7];
+
   carthw_ssf2_write16(a, d);
-  if (a == 0x130f0)
-    bank_switch_rom_68k(Pico32x.regs[4 / 2]);
+  if ((a & ~0x0e) == 0xa130f0) {
+    if (carthw_ssf2_banks[(a >> 1) & 7] != bank)
+      p32x_update_banks(); // SH2 sees the new bank too
+    else
+      bank_switch_rom_68k(Pico32x.regs[4 / 2]);
+  }
 }
 
 // before ADEN
@@ -1658,6 +1670,24 @@ void NOINLINE sh2_sdram_checks_l(u32 a, u32 d, SH2 *sh2, u32 t)
   if (t & ~0x800080)    sh2_drc_wcheck_ram(a, 4, sh2);
 }
 
+// checks for a block written at once, with only one call for code removal
+static void sh2_sdram_checks_block(u32 a, int len, SH2 *sh2)
+{
+  u8 *p = sh2->p_drcblk_ram;
+  u32 a1 = a & 0x3fffe;
+  u32 t, smc = 0;
+  int i;
+
+  for (i = 0; i < len; i += 2) {
+    t = p[(a1 + i) >> SH2_DRCBLK_RAM_SHIFT];
+    if (t & 0x80)
+      sh2_sdram_poll(a + i, ((u16 *)sh2->p_sdram)[(a1 + i) / 2], sh2);
+    smc |= t;
+  }
+  if (smc & 0x7f)
+    sh2_drc_wcheck_ram(a, len, sh2);
+}
+
 #ifndef _ASM_32X_MEMORY_C
 static void sh2_da_checks(u32 a, u32 t, SH2 *sh2)
 {
@@ -2026,6 +2056,39 @@ int p32x_sh2_mem_is_rom(u32 a, SH2 *sh2)
   return 0;
 }
 
+// write a block of halfwords to SDRAM or the frame buffer in one go, for DMA.
+// Returns the number of halfwords written, 0 if the handlers must be used
+int p32x_sh2_write16_block(u32 dst, const u16 *src, int count, SH2 *sh2)
+{
+  u32 a1, size;
+  u8 *pd;
+  int len;
+
+  if ((dst & 0xde000001) == 0x06000000) {
+    a1 = dst & 0x3fffe, size = 0x40000;
+    pd = (u8 *)sh2->p_sdram + a1;
+  } else if ((dst & 0xde020001) == 0x04000000) {
+    // frame buffer, but not the overwrite area
+    a1 = dst & 0x1fffe, size = 0x20000;
+    pd = (u8 *)sh2->p_dram + a1;
+  } else
+    return 0;
+
+  len = count * 2;
+  if (a1 + len > size)
+    len = size - a1;
+  // DMA copies upwards, which memmove only does if dst is below src
+  if (pd > (u8 *)src && pd < (u8 *)src + len)
+    return 0;
+  memmove(pd, src, len);
+
+#ifdef DRC_SH2
+  if (size == 0x40000)
+    sh2_sdram_checks_block(dst, len, sh2);
+#endif
+  return len / 2;
+}
+
 int p32x_sh2_memcpy(u32 dst, u32 src, int count, int size, SH2 *sh2)
 {
   u32 mask;
@@ -2064,6 +2127,9 @@ int p32x_sh2_memcpy(u32 dst, u32 src, int count, int size, SH2 *sh2)
   } else {
     // dst and src at least halfword aligned
     u16 *sp = (u16 *)ps;
+    // SDRAM or frame buffer, copy all at once
+    i = p32x_sh2_write16_block(dst, sp, len / 2, sh2);
+    sp += i, dst += 2*i, len -= 2*i;
     // align dst to word
     if ((dst & 2) && len >= 2) {
       p32x_sh2_write16(dst, *sp++, sh2);
@@ -2537,7 +2603,7 @@ void p32x_update_banks(void)
   bank_switch_rom_68k(Pico32x.regs[4 / 2]);
   bank_switch_rom_sh2();
   if (Pico32x.emu_flags & P32XF_DRC_ROM_C)
-    sh2_drc_flush_all();
+    sh2_drc_rom_banked();
 }
 
 void Pico32xMemStateLoaded(void)
@@ -2554,7 +2620,7 @@ void Pico32xMemStateLoaded(void)
   ssh2.poll_addr = ssh2.poll_cycles = ssh2.poll_cnt = 0;
   memset(sh2_poll_fifo, 0, sizeof(sh2_poll_fifo));
 
-  sh2_drc_flush_all();
+  sh2_drc_state_loaded();
 }
 
 // vim:shiftwidth=2:ts=2:expandtab
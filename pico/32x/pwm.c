@@ -64,6 +64,22 @@ static int convert_sample(unsigned int v)
   return (v * pwm.mult >> 8) - 0x10000/2;
 }
 
+// output n samples of the current values
+static void fill_samples(int n)
+{
+  short *pwmb = Pico32xMem->pwm;
+  int ptr = pwm.ptr;
+
+  pwm.ptr = (ptr + n) & (PWM_BUFF_LEN - 1);
+  if (n > PWM_BUFF_LEN) // only the last ones survive in the ring
+    ptr = pwm.ptr, n = PWM_BUFF_LEN;
+  while (n-- > 0) {
+    pwmb[ptr * 2    ] = pwm.current[0];
+    pwmb[ptr * 2 + 1] = pwm.current[1];
+    ptr = (ptr + 1) & (PWM_BUFF_LEN - 1);
+  }
+}
+
 #define consume_fifo(sh2, m68k_cycles) { \
   int cycles_diff = ((m68k_cycles) * 3) - Pico32x.pwm_cycle_p; \
   if (cycles_diff >= pwm.cycles) \
@@ -90,6 +106,25 @@ static void consume_fifo_do(SH2 *sh2, unsigned int m68k_cycles,
 
   while (sh2_cycles_diff >= pwm.cycles)
   {
+    if ((Pico32x.pwm_p[0] | Pico32x.pwm_p[1]) == 0 && Pico32x.pwm_irq_cnt > 1) {
+      // FIFOs empty, output is constant up to the next irq. Do it in one go
+      int n = sh2_cycles_diff / pwm.cycles;
+      if (n > Pico32x.pwm_irq_cnt - 1)
+        n = Pico32x.pwm_irq_cnt - 1;
+      sh2_cycles_diff -= n * pwm.cycles;
+      Pico32x.pwm_irq_cnt -= n;
+      fill_samples(n);
+
+      if (pwm.irq_state >= PWM_IRQ_LOW) {
+        // buffer underrun for each of them, as below
+        if (pwm.irq_reload > pwm.irq_timer)
+          pwm.irq_reload = (pwm.irq_reload - n > pwm.irq_timer ?
+                            pwm.irq_reload - n : pwm.irq_timer);
+        pwm.irq_state = PWM_IRQ_LOW;
+      }
+      continue;
+    }
+
     sh2_cycles_diff -= pwm.cycles;
 
     if (Pico32x.pwm_p[0] > 0) {
@@ -546,7 +546,7 @@ void REGPARM(3) sh2_peripheral_write32(u32 a, u32 d, SH2 *sh2)
 static void dreq0_do(SH2 *sh2, struct dma_chan *chan)
 {
   unsigned short dreqlen = Pico32x.regs[0x10 / 2];
-  int i;
+  int i, n;
 
   // debug/sanity checks
   if (chan->tcr < dreqlen || chan->tcr > dreqlen + 4)
@@ -561,7 +561,19 @@ static void dreq0_do(SH2 *sh2, struct dma_chan *chan)
   // HACK: assume bus is busy and SH2 is halted
   sh2->state |= SH2_STATE_SLEEP;
 
-  for (i = 0; i < Pico32x.dmac0_fifo_ptr && chan->tcr > 0; i++) {
+  // FIFO to SDRAM or frame buffer, write all at once
+  n = Pico32x.dmac0_fifo_ptr;
+  if (n > chan->tcr)
+    n = chan->tcr;
+  i = p32x_sh2_write16_block(chan->dar, Pico32x.dmac_fifo, n, sh2);
+  if (i > 0) {
+    elprintf_sh2(sh2, EL_32XP, "dreq0 [%08x] %d words, dreq_len %d",
+      chan->dar, i, dreqlen);
+    chan->dar += 2*i;
+    chan->tcr -= i;
+  }
+
+  for (; i < Pico32x.dmac0_fifo_ptr && chan->tcr > 0; i++) {
     elprintf_sh2(sh2, EL_32XP, "dreq0 [%08x] %04x, dreq_len %d",
       chan->dar, Pico32x.dmac_fifo[i], dreqlen);
     p32x_sh2_write16(chan->dar, Pico32x.dmac_fifo[i], sh2);
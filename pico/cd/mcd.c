@@ -225,7 +225,7 @@ typedef void (event_cb)(unsigned int now);
 
 /* times are in s68k (12.5MHz) cycles */
 unsigned int pcd_event_times[PCD_EVENT_COUNT];
-static unsigned int event_time_next;
+static struct pico_events pcd_events = { pcd_event_times, PCD_EVENT_COUNT };
 static event_cb *pcd_event_cbs[PCD_EVENT_COUNT] = {
   pcd_cdc_event,            // PCD_EVENT_CDC
   pcd_int3_timer_event,     // PCD_EVENT_TIMER3
@@ -239,7 +239,7 @@ void pcd_event_schedule(unsigned int now, enum pcd_event event, int after)
 
   if ((now|after) == 0) {
     // event cancelled
-    pcd_event_times[event] = 0;
+    pico_event_set(&pcd_events, event, 0);
     return;
   }
 
@@ -247,10 +247,7 @@ void pcd_event_schedule(unsigned int now, enum pcd_event event, int after)
   when |= 1;
 
   elprintf(EL_CD, "cd: new event #%u %u->%u", event, now, when);
-  pcd_event_times[event] = when;
-
-  if (event_time_next == 0 || CYCLES_GT(event_time_next, when))
-    event_time_next = when;
+  pico_event_set(&pcd_events, event, when);
 }
 
 void pcd_event_schedule_s68k(enum pcd_event event, int after)
@@ -262,41 +259,16 @@ void pcd_event_schedule_s68k(enum pcd_event event, int after)
 
 static void pcd_run_events(unsigned int until)
 {
-  int oldest, oldest_diff, time;
-  int i, diff;
-
-  while (1) {
-    oldest = -1, oldest_diff = 0x7fffffff;
-
-    for (i = 0; i < PCD_EVENT_COUNT; i++) {
-      if (pcd_event_times[i]) {
-        diff = pcd_event_times[i] - until;
-        if (diff < oldest_diff) {
-          oldest_diff = diff;
-          oldest = i;
-        }
-      }
-    }
+  unsigned int time;
+  int event;
 
-    if (oldest_diff <= 0) {
-      time = pcd_event_times[oldest];
-      pcd_event_times[oldest] = 0;
-      elprintf(EL_CD, "cd: run event #%d %u", oldest, time);
-      pcd_event_cbs[oldest](time);
-    }
-    else if (oldest_diff < 0x7fffffff) {
-      event_time_next = pcd_event_times[oldest];
-      break;
-    }
-    else {
-      event_time_next = 0;
-      break;
-    }
+  while ((event = pico_event_pop(&pcd_events, until, &time)) >= 0) {
+    elprintf(EL_CD, "cd: run event #%d %u", event, time);
+    pcd_event_cbs[event](time);
   }
 
-  if (oldest != -1)
-    elprintf(EL_CD, "cd: next event #%d at %u",
-      oldest, event_time_next);
+  if (pcd_events.next)
+    elprintf(EL_CD, "cd: next event at %u", pcd_events.next);
 }
 
 void pcd_irq_s68k(int irq, int state)
@@ -329,12 +301,12 @@ int pcd_sync_s68k(unsigned int m68k_target, int m68k_poll_sync)
   }
 
   while (CYCLES_GT(s68k_target, now)) {
-    if (event_time_next && CYCLES_GE(now, event_time_next))
+    if (pcd_events.next && CYCLES_GE(now, pcd_events.next))
       pcd_run_events(now);
 
     target = s68k_target;
-    if (event_time_next && CYCLES_GT(target, event_time_next))
-      target = event_time_next;
+    if (pcd_events.next && CYCLES_GT(target, pcd_events.next))
+      target = pcd_events.next;
 
     if (Pico_mcd->m.state_flags & (PCD_ST_S68K_POLL|PCD_ST_S68K_SLEEP))
       SekCycleCntS68k = SekCycleAimS68k = target;
@@ -443,6 +415,8 @@ void pcd_state_loaded(void)
 {
   unsigned int cycles;
 
+  pico_events_rebuild(&pcd_events);
+
   pcd_state_loaded_mem();
 
   memset(Pico_mcd->pcm_mixbuf, 0, sizeof(Pico_mcd->pcm_mixbuf));
@@ -471,8 +445,7 @@ void pcd_state_loaded(void)
     Pico_mcd->m.need_sync = 0;
   }
 
-  // reschedule
-  event_time_next = 0;
+  // run events which might be overdue
   pcd_run_events(SekCycleCntS68k);
 
   // msd
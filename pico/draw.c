@@ -44,6 +44,7 @@
  */
 
 #include "pico_int.h"
+#include "simd_features.h"
 #include <platform/common/upscale.h>
 
 #define FORCE	// layer forcing via debug register?
@@ -197,8 +198,37 @@ TileFlipMaker_(pix_func,m)
 #define pix_just_write(x) \
   if (likely(t)) pd[x]=pal|t
 
+#if defined(HAVE_SIMD) && CPU_IS_LE
+// expand all 8 pixels at once, then merge the non-transparent ones into pd.
+// pixel order in pack bytes 0-3 is 2 3 0 1 6 7 4 5, high nibble first
+static inline void TileWrite8(unsigned char *pd, u8x8 pix, unsigned char pal)
+{
+  u8x8 old = *(u8x8 *)pd;
+  u8x8 nz = (u8x8)(pix != 0);
+  *(u8x8 *)pd = (old & ~nz) | ((pix | pal) & nz);
+}
+
+static void TileNorm(unsigned char *pd, unsigned int pack, unsigned char pal)
+{
+  const u8x8 hmask = { 0xff, 0, 0xff, 0, 0xff, 0, 0xff, 0 };
+  u8x8 b = (u8x8)(u32x2){ pack, 0 };
+
+  b = SIMD_SHUFFLE8(b, 1,1,0,0,3,3,2,2);
+  TileWrite8(pd, ((b >> 4) & hmask) | (b & 0x0f & ~hmask), pal);
+}
+
+static void TileFlip(unsigned char *pd, unsigned int pack, unsigned char pal)
+{
+  const u8x8 hmask = { 0, 0xff, 0, 0xff, 0, 0xff, 0, 0xff };
+  u8x8 b = (u8x8)(u32x2){ pack, 0 };
+
+  b = SIMD_SHUFFLE8(b, 2,2,3,3,0,0,1,1);
+  TileWrite8(pd, ((b >> 4) & hmask) | (b & 0x0f & ~hmask), pal);
+}
+#else
 TileNormMaker(TileNorm, pix_just_write)
 TileFlipMaker(TileFlip, pix_just_write)
+#endif
 
 #ifndef _ASM_DRAW_C
 
@@ -1468,13 +1498,34 @@ static void PicoDoHighPal555_8bit(int sh, int line, struct PicoEState *est)
 void PicoDoHighPal555(int sh, int line, struct PicoEState *est)
 {
   unsigned int *spal, *dpal;
-  unsigned int t, i;
+  unsigned int i;
 
   est->Pico->m.dirtyPal = 0;
 
   spal = (void *)PicoMem.cram;
   dpal = (void *)est->HighPal;
 
+#ifdef HAVE_SIMD
+  // same as below, 8 colours at a time
+  for (i = 0; i < 0x40 / 2; i += 4) {
+    u32x4 v = *(u32x4 *)(spal + i);
+    v = PXCONV(v);
+    v |= (v >> 4) & PXMASKL;
+    v |= ((v ^ PXMASKL) & (v>>3|v>>2) & PXMASKL) << 1;
+    *(u32x4 *)(dpal + i) = *(u32x4 *)(dpal + 0xc0/2 + i) = v;
+  }
+
+  if (sh)
+  {
+    for (i = 0; i < 0x40 / 2; i += 4) {
+      u32x4 v = (*(u32x4 *)(dpal + i) >> 1) & PXMASKH;
+      *(u32x4 *)(dpal + 0x80/2 + i) = v + ((v>>2|v>>1|v>>0) & (PXMASKL<<1));
+      *(u32x4 *)(dpal + 0x40/2 + i) = v + PXMASKH + PXMASKL;
+    }
+  }
+#else
+  unsigned int t;
+
   for (i = 0; i < 0x40 / 2; i++) {
     t = spal[i];
     // treat it like it was 4-bit per channel, since in s/h mode it somewhat is that.
@@ -1501,6 +1552,7 @@ void PicoDoHighPal555(int sh, int line, struct PicoEState *est)
       dpal[0x40/2 + i] = t + PXMASKH + PXMASKL;
     }
   }
+#endif
 }
 
 void FinalizeLine555(int sh, int line, struct PicoEState *est)
@@ -0,0 +1,120 @@
+/*
+ * PicoDrive
+ * event scheduling for add-on hardware
+ *
+ * This work is licensed under the terms of MAME license.
+ * See COPYING file in the top-level directory.
+ *
+ * Pending events are kept in a binary min-heap ordered by time, so that the
+ * next event is always at the top and (re)scheduling is O(log n). The times
+ * array is owned by the user and is what goes into the save state, the heap
+ * needs to be rebuilt from it after it was modified directly.
+ */
+
+#include "pico_int.h"
+
+// event a is due before event b
+#define EV_BEFORE(ev, a, b) \
+  CYCLES_GT((ev)->times[b], (ev)->times[a])
+
+static void heap_swap(struct pico_events *ev, int i, int j)
+{
+  int a = ev->heap[i], b = ev->heap[j];
+
+  ev->heap[i] = b, ev->pos[b] = i+1;
+  ev->heap[j] = a, ev->pos[a] = j+1;
+}
+
+static void heap_up(struct pico_events *ev, int i)
+{
+  while (i > 0) {
+    int p = (i-1) / 2;
+    if (!EV_BEFORE(ev, ev->heap[i], ev->heap[p]))
+      break;
+    heap_swap(ev, i, p);
+    i = p;
+  }
+}
+
+static void heap_down(struct pico_events *ev, int i)
+{
+  while (1) {
+    int l = 2*i + 1, m = i;
+    if (l < ev->count && EV_BEFORE(ev, ev->heap[l], ev->heap[m]))
+      m = l;
+    if (l+1 < ev->count && EV_BEFORE(ev, ev->heap[l+1], ev->heap[m]))
+      m = l+1;
+    if (m == i)
+      break;
+    heap_swap(ev, i, m);
+    i = m;
+  }
+}
+
+static void heap_remove(struct pico_events *ev, int event)
+{
+  int i = ev->pos[event] - 1;
+  int last = --ev->count;
+
+  ev->pos[event] = 0;
+  if (i != last) {
+    ev->heap[i] = ev->heap[last];
+    ev->pos[ev->heap[i]] = i+1;
+    heap_down(ev, i);
+    heap_up(ev, i);
+  }
+}
+
+static void update_next(struct pico_events *ev)
+{
+  ev->next = ev->count ? ev->times[ev->heap[0]] : 0;
+}
+
+void pico_events_rebuild(struct pico_events *ev)
+{
+  int i;
+
+  ev->count = 0;
+  for (i = 0; i < ev->size; i++) {
+    ev->pos[i] = 0;
+    if (ev->times[i]) {
+      ev->heap[ev->count] = i;
+      ev->pos[i] = ++ev->count;
+      heap_up(ev, ev->count-1);
+    }
+  }
+  update_next(ev);
+}
+
+// schedule event at time 'when', or cancel it if when is 0
+void pico_event_set(struct pico_events *ev, int event, unsigned int when)
+{
+  if (ev->pos[event])
+    heap_remove(ev, event);
+
+  ev->times[event] = when;
+  if (when) {
+    ev->heap[ev->count] = event;
+    ev->pos[event] = ++ev->count;
+    heap_up(ev, ev->count-1);
+  }
+  update_next(ev);
+}
+
+// dequeue the next event if it's due at 'until', returns -1 if there's none
+int pico_event_pop(struct pico_events *ev, unsigned int until, unsigned int *when)
+{
+  int event;
+
+  if (ev->count == 0 || CYCLES_GT(ev->next, until))
+    return -1;
+
+  event = ev->heap[0];
+  *when = ev->times[event];
+  ev->times[event] = 0;
+  heap_remove(ev, event);
+  update_next(ev);
+  return event;
+}
+
+// vim:shiftwidth=2:ts=2:expandtab
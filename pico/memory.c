@@ -12,6 +12,7 @@
 #include "pico_int.h"
 #include "memory.h"
 #include "state.h"
+#include <cpu/debug.h>
 
 #include "sound/ym2612.h"
 #include "sound/sn76496.h"
@@ -88,6 +89,7 @@ void cpu68k_map_set(uptr *map, u32 start_addr, u32 end_addr,
     const void *func_or_mh, int is_func)
 {
   xmap_set(map, M68K_MEM_SHIFT, start_addr, end_addr, func_or_mh, is_func & 1);
+  pdb_watch_remap();
 #ifdef EMU_F68K
   // setup FAME fetchmap
   if (!(is_func & 1))
@@ -122,6 +124,7 @@ void cpu68k_map_read_mem(u32 start_addr, u32 end_addr, void *ptr, int is_sub)
   addr >>= 1;
   for (i = start_addr >> shift; i <= end_addr >> shift; i++)
     r8map[i] = r16map[i] = addr;
+  pdb_watch_remap();
 #ifdef EMU_F68K
   // setup FAME fetchmap
   {
@@ -158,6 +161,7 @@ void cpu68k_map_all_ram(u32 start_addr, u32 end_addr, void *ptr, int is_sub)
   addr >>= 1;
   for (i = start_addr >> shift; i <= end_addr >> shift; i++)
     r8map[i] = r16map[i] = w8map[i] = w16map[i] = addr;
+  pdb_watch_remap();
 #ifdef EMU_F68K
   // setup FAME fetchmap
   {
@@ -190,6 +194,7 @@ void cpu68k_map_read_funcs(u32 start_addr, u32 end_addr, u32 (*r8)(u32), u32 (*r
   ar16 = (ar16 >> 1 ) | MAP_FLAG;
   for (i = start_addr >> shift; i <= end_addr >> shift; i++)
     r8map[i] = ar8, r16map[i] = ar16;
+  pdb_watch_remap();
 }
 
 void cpu68k_map_all_funcs(u32 start_addr, u32 end_addr, u32 (*r8)(u32), u32 (*r16)(u32), void (*w8)(u32, u32), void (*w16)(u32, u32), int is_sub)
@@ -218,6 +223,7 @@ void cpu68k_map_all_funcs(u32 start_addr, u32 end_addr, u32 (*r8)(u32), u32 (*r1
   aw16 = (aw16 >> 1 ) | MAP_FLAG;
   for (i = start_addr >> shift; i <= end_addr >> shift; i++)
     r8map[i] = ar8, r16map[i] = ar16, w8map[i] = aw8, w16map[i] = aw16;
+  pdb_watch_remap();
 }
 
 u32 PicoRead16_floating(u32 a)
@@ -295,6 +301,7 @@ void m68k_map_unmap(u32 start_addr, u32 end_addr)
   for (i = start_addr >> shift; i <= end_addr >> shift; i++)
     m68k_write16_map[i] = (addr >> 1) | MAP_FLAG;
 #endif
+  pdb_watch_remap();
 }
 
 #ifndef _ASM_MEMORY_C
@@ -777,6 +784,14 @@ static int z80_cycles_from_68k(void)
   return cycles_68k_to_z80(m68k_cnt);
 }
 
+// batched lines are only run with a stopped z80 (see lines_quiet), end the
+// batch at the current line if it is started
+static void z80_batch_end(void)
+{
+  if (unlikely(Pico.t.batch_end) && !(PicoIn.opt & POPT_Z80_LAZY_SYNC))
+    PicoBatchEnd();
+}
+
 void NOINLINE ctl_write_z80busreq(u32 d)
 {
   d&=1; d^=1;
@@ -785,6 +800,7 @@ void NOINLINE ctl_write_z80busreq(u32 d)
   {
     if (d)
     {
+      z80_batch_end();
       Pico.t.z80c_aim = Pico.t.z80c_cnt = z80_cycles_from_68k() + 2;
       Pico.t.z80c_cnt += Pico.t.z80_busdelay >> 8;
       Pico.t.z80_busdelay &= 0xff;
@@ -826,6 +842,7 @@ void NOINLINE ctl_write_z80reset(u32 d)
     }
     else
     {
+      z80_batch_end();
       Pico.t.z80c_aim = Pico.t.z80c_cnt = z80_cycles_from_68k() + 2;
       z80_reset();
     }
@@ -833,8 +850,19 @@ void NOINLINE ctl_write_z80reset(u32 d)
   }
 }
 
+// with lazy sync the z80 only runs at a few points in a frame. Catch it up
+// if the 68k is about to access something the z80 may have touched as well
+static void z80_sync_lazy(void)
+{
+  if ((PicoIn.opt & (POPT_EN_Z80|POPT_Z80_LAZY_SYNC)) ==
+        (POPT_EN_Z80|POPT_Z80_LAZY_SYNC) &&
+      Pico.m.z80Run && !Pico.m.z80_reset)
+    PicoSyncZ80(SekCyclesDone());
+}
+
 static void psg_write_68k(u32 d)
 {
+  z80_sync_lazy();
   PsndDoPSG(z80_cycles_from_68k());
   SN76496Write(d);
 }
@@ -953,6 +981,7 @@ static u32 PicoRead8_z80(u32 a)
     elprintf(EL_ANOMALY, "68k z80 read with no bus! [%06x] @ %06x", a, SekPc);
     return (u8)PicoRead16_floating(a);
   }
+  z80_sync_lazy(); // z80 may be running with PQUIRK_NO_Z80_BUS_LOCK
   SekCyclesBurnRun(1);
 
   if ((a & 0x4000) == 0x0000) {
@@ -979,6 +1008,7 @@ static void PicoWrite8_z80(u32 a, u32 d)
     elprintf(EL_ANOMALY, "68k z80 write with no bus or reset! [%06x] %02x @ %06x", a, d&0xff, SekPc);
     return;
   }
+  z80_sync_lazy();
   SekCyclesBurnRun(1);
 
   if ((a & 0x4000) == 0x0000) { // z80 RAM
@@ -1348,6 +1378,15 @@ static int get_scanline(int is_from_z80)
   if (xcycles >= Pico.t.timer_b_next_oflow) \
     ym2612.OPN.ST.status |= (ym2612.OPN.ST.mode >> 2) & 2
 
+// advance the next overflow of a running timer past xcycles. Overflows are
+// only evaluated on access, so there may be many periods to skip at once
+static int ym2612_timer_oflow(int next_oflow, int step, int xcycles)
+{
+  if (xcycles >= next_oflow)
+    next_oflow += ((unsigned)(xcycles - next_oflow) / step + 1) * step;
+  return next_oflow;
+}
+
 /* probably should not be in this file, but it's near related code here */
 void ym2612_sync_timers(int z80_cycles, int mode_old, int mode_new)
 {
@@ -1358,8 +1397,8 @@ void ym2612_sync_timers(int z80_cycles, int mode_old, int mode_new)
 
   // update timer a
   if (mode_old & 1)
-    while (xcycles >= Pico.t.timer_a_next_oflow)
-      Pico.t.timer_a_next_oflow += Pico.t.timer_a_step;
+    Pico.t.timer_a_next_oflow = ym2612_timer_oflow(Pico.t.timer_a_next_oflow,
+                                    Pico.t.timer_a_step, xcycles);
 
   // turning on/off
   if ((mode_old ^ mode_new) & 1)
@@ -1382,8 +1421,8 @@ void ym2612_sync_timers(int z80_cycles, int mode_old, int mode_new)
 
   // update timer b
   if (mode_old & 2)
-    while (xcycles >= Pico.t.timer_b_next_oflow)
-      Pico.t.timer_b_next_oflow += Pico.t.timer_b_step;
+    Pico.t.timer_b_next_oflow = ym2612_timer_oflow(Pico.t.timer_b_next_oflow,
+                                    Pico.t.timer_b_step, xcycles);
 
   // turning on/off
   if ((mode_old ^ mode_new) & 2)
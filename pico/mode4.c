@@ -10,6 +10,7 @@
  * See COPYING file in the top-level directory.
  */
 #include "pico_int.h"
+#include "simd_features.h"
 #include <platform/common/upscale.h>
 
 static void (*FinalizeLineSMS)(int line);
@@ -70,43 +71,75 @@ static void TileBGM4(u16 sx, int pal)
   }
 }
 
-// 8 pixels are arranged in 4 bitplane bytes in a 32 bit word. To pull the
-// 4 bitplanes together multiply with each bit distance (multiples of 1<<7)
-#define PLANAR_PIXELBG(x,p) \
-  t = (pack>>(7-p)) & 0x01010101; \
-  t = (t*0x10204080) >> 28; \
-  pd[x] = pal|t;
+// 8 pixels are arranged in 4 bitplane bytes in a 32 bit word, pixel 0 in bit 7
+#if defined(HAVE_SIMD) && CPU_IS_LE
+// convert all 8 pixels at once by testing each pixel bit in each bitplane
+static inline u8x8 PlanarToChunky(unsigned int pack, u8x8 bits)
+{
+  u8x8 b = (u8x8)(u32x2){ pack, 0 };
+
+  return ((u8x8)((SIMD_SHUFFLE8(b, 0,0,0,0,0,0,0,0) & bits) != 0) & 1) |
+         ((u8x8)((SIMD_SHUFFLE8(b, 1,1,1,1,1,1,1,1) & bits) != 0) & 2) |
+         ((u8x8)((SIMD_SHUFFLE8(b, 2,2,2,2,2,2,2,2) & bits) != 0) & 4) |
+         ((u8x8)((SIMD_SHUFFLE8(b, 3,3,3,3,3,3,3,3) & bits) != 0) & 8);
+}
 
 static void TileNormBGM4(u16 sx, unsigned int pack, int pal)
 {
-  u8 *pd = Pico.est.HighCol + sx;
-  u32 t;
-
-  PLANAR_PIXELBG(0, 0)
-  PLANAR_PIXELBG(1, 1)
-  PLANAR_PIXELBG(2, 2)
-  PLANAR_PIXELBG(3, 3)
-  PLANAR_PIXELBG(4, 4)
-  PLANAR_PIXELBG(5, 5)
-  PLANAR_PIXELBG(6, 6)
-  PLANAR_PIXELBG(7, 7)
+  const u8x8 bits = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+  *(u8x8 *)(Pico.est.HighCol + sx) = PlanarToChunky(pack, bits) | (u8)pal;
 }
 
 static void TileFlipBGM4(u16 sx, unsigned int pack, int pal)
 {
-  u8 *pd = Pico.est.HighCol + sx;
-  u32 t;
+  const u8x8 bits = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+  *(u8x8 *)(Pico.est.HighCol + sx) = PlanarToChunky(pack, bits) | (u8)pal;
+}
+#else
+// convert 4 pixels at once. A bitplane nibble is looked up in a table with the
+// 4 pixel bits spread to one byte each, then all 4 bitplanes are merged
+#if CPU_IS_LE
+#define PL2CH(n) (((n)>>3&1) | ((n)>>2&1)<<8 | ((n)>>1&1)<<16 | ((n)&1)<<24)
+#else
+#define PL2CH(n) (((n)>>3&1)<<24 | ((n)>>2&1)<<16 | ((n)>>1&1)<<8 | ((n)&1))
+#endif
+#define PL2CH4(n) PL2CH(n), PL2CH(n+1), PL2CH(n+2), PL2CH(n+3)
+static const u32 pl2ch[16] = { PL2CH4(0), PL2CH4(4), PL2CH4(8), PL2CH4(12) };
+#define PL2CH_FLIP(n) PL2CH(((n)&1)<<3 | ((n)&2)<<1 | ((n)&4)>>1 | ((n)&8)>>3)
+#define PL2CH_FLIP4(n) PL2CH_FLIP(n), PL2CH_FLIP(n+1), PL2CH_FLIP(n+2), PL2CH_FLIP(n+3)
+static const u32 pl2ch_flip[16] =
+  { PL2CH_FLIP4(0), PL2CH_FLIP4(4), PL2CH_FLIP4(8), PL2CH_FLIP4(12) };
 
-  PLANAR_PIXELBG(0, 7)
-  PLANAR_PIXELBG(1, 6)
-  PLANAR_PIXELBG(2, 5)
-  PLANAR_PIXELBG(3, 4)
-  PLANAR_PIXELBG(4, 3)
-  PLANAR_PIXELBG(5, 2)
-  PLANAR_PIXELBG(6, 1)
-  PLANAR_PIXELBG(7, 0)
+#define PLANAR_NIBBLE(tab,s) \
+  (tab[(pack>>(s))&0xf] | tab[(pack>>((s)+8))&0xf]<<1 | \
+   tab[(pack>>((s)+16))&0xf]<<2 | tab[(pack>>((s)+24))&0xf]<<3)
+
+static void TileWriteBGM4(u16 sx, u32 t0, u32 t1, int pal)
+{
+  t0 |= pal * 0x01010101, t1 |= pal * 0x01010101;
+  if (sx & 3) {
+    u8 *pd = (u8 *)(Pico.est.HighCol + sx);
+    memcpy(pd, &t0, 4);
+    memcpy(pd+4, &t1, 4);
+  } else {
+    u32 *pd = (u32 *)(Pico.est.HighCol + sx);
+    pd[0] = t0, pd[1] = t1;
+  }
+}
+
+static void TileNormBGM4(u16 sx, unsigned int pack, int pal)
+{
+  TileWriteBGM4(sx, PLANAR_NIBBLE(pl2ch, 4), PLANAR_NIBBLE(pl2ch, 0), pal);
+}
+
+static void TileFlipBGM4(u16 sx, unsigned int pack, int pal)
+{
+  TileWriteBGM4(sx, PLANAR_NIBBLE(pl2ch_flip, 0), PLANAR_NIBBLE(pl2ch_flip, 4), pal);
 }
+#endif
 
+// 8 pixels are arranged in 4 bitplane bytes in a 32 bit word. To pull the
+// 4 bitplanes together multiply with each bit distance (multiples of 1<<7)
 // non-transparent sprite pixels apply if no higher prio pixel is already there
 #define PLANAR_PIXELSP(x,p) \
   t = (pack>>(7-p)) & 0x01010101; \
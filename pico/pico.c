@@ -11,6 +11,7 @@
 #include "pico_int.h"
 #include "sound/ym2612.h"
 #include "sound/vgm.h"
+#include <cpu/debug.h>
 
 struct Pico Pico;
 struct PicoMem PicoMem;
@@ -260,6 +261,12 @@ void PicoLoopPrepare(void)
 
 #include "pico_cmn.c"
 
+// VDP access in a batched run, see run_lines_batched
+void PicoBatchEnd(void)
+{
+  batch_end_line();
+}
+
 /* sync z80 to 68k */
 PICO_INTERNAL void PicoSyncZ80(unsigned int m68k_cycles_done)
 {
@@ -288,6 +295,7 @@ void PicoFrame(void)
   pprof_start(frame);
 
   Pico.m.frame_count++;
+  pdb_frame();
 
   if (PicoIn.AHW & PAHW_VGM) {
     vgm_frame();
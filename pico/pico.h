@@ -82,6 +82,8 @@ extern void *p32x_bios_g, *p32x_bios_m, *p32x_bios_s;
 #define POPT_FM_YM2612      (1<<24) //x00 0000
 #define POPT_EN_FM_FILTER   (1<<25)
 #define POPT_EN_KBD         (1<<26)
+#define POPT_EN_DRC_HUGEPAGE (1<<27)
+#define POPT_Z80_LAZY_SYNC  (1<<28)
 
 #define PAHW_MCD    (1<<0)
 #define PAHW_32X    (1<<1)
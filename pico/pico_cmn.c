@@ -14,6 +14,7 @@
 #ifndef CPUS_RUN
 #define CPUS_RUN(m68k_cycles) \
   SekRunM68k(m68k_cycles)
+#define CPUS_BATCH // only the 68k (and z80) run, quiet lines may be batched
 #endif
 
 // sync m68k to Pico.t.m68c_aim
@@ -112,7 +113,7 @@ static void do_timing_hacks_end(struct PicoVideo *pv)
   PicoVideoFIFOSync(CYCLES_M68K_LINE);
 
   // need rather tight Z80 sync for emulation of main bus cycle stealing
-  if (Pico.m.scanline&1)
+  if ((Pico.m.scanline&1) && !(PicoIn.opt & POPT_Z80_LAZY_SYNC))
     if (Pico.m.z80Run && !Pico.m.z80_reset && (PicoIn.opt&POPT_EN_Z80))
       PicoSyncZ80(Pico.t.m68c_aim);
 }
@@ -128,6 +129,88 @@ static void do_timing_hacks_start(struct PicoVideo *pv)
   Pico.t.m68c_aim += Pico.m.scanline&1; // add 1 every 2 lines for 488.5 cycles
 }
 
+#ifdef CPUS_BATCH
+// Lines in VBLANK with nothing to do besides running the CPUs are run in one
+// go. The line state is caught up if the 68k accesses the VDP, which also ends
+// the batch at the end of the current line.
+
+// advance line state of a batched run to the line containing cycles
+static void batch_sync_lines(unsigned int cycles)
+{
+  struct PicoVideo *pv = &Pico.video;
+  int len = CYCLES_M68K_LINE + (Pico.m.scanline & 1);
+
+  while (Pico.m.scanline < Pico.t.batch_end - 1 &&
+         cycles - Pico.t.m68c_line_start >= len)
+  {
+    Pico.t.m68c_line_start += len;
+    Pico.m.scanline++;
+    pv->v_counter = PicoVideoGetV(Pico.m.scanline, 1);
+    len = CYCLES_M68K_LINE + (Pico.m.scanline & 1);
+  }
+}
+
+static void batch_end_line(void)
+{
+  int y = Pico.m.scanline;
+  unsigned int aim;
+  int cyc;
+
+  batch_sync_lines(SekCyclesDone());
+  if (Pico.m.scanline != y)
+    PicoVideoFIFOHint(); // FIFO is idle, only resets the slot
+  Pico.t.batch_end = 0;
+
+  // cut the current timeslice at the end of the line
+  aim = Pico.t.m68c_line_start + CYCLES_M68K_LINE + (Pico.m.scanline & 1);
+  cyc = Pico.t.m68c_aim - aim;
+  if (cyc > 0) {
+    Pico.t.m68c_aim -= cyc;
+    Pico.t.m68c_cnt -= cyc;
+    SekCyclesLeft -= cyc;
+    Pico.t.refresh_delay -= cyc * 0x108; // return refresh slowdown, see SekRunM68k
+  }
+}
+
+static int lines_quiet(struct PicoVideo *pv)
+{
+  // a running z80 needs the tight sync in do_timing_hacks_end, unless lazy
+  int z80_quiet = !Pico.m.z80Run || Pico.m.z80_reset ||
+    !(PicoIn.opt & POPT_EN_Z80) || (PicoIn.opt & POPT_Z80_LAZY_SYNC);
+
+  return !(pv->status & PVS_ACTIVE) && !PicoLineHook && !port_lightgun &&
+    z80_quiet && PicoVideoFIFOIdle();
+}
+
+// run count lines starting at y, returns the number of lines actually done
+static int run_lines_batched(struct PicoVideo *pv, int y, int count)
+{
+  unsigned int cycles = CYCLES_M68K_LINE;
+  int l;
+
+  // line y is extended in do_timing_hacks_start
+  for (l = y+1; l < y+count; l++)
+    cycles += CYCLES_M68K_LINE + (l & 1);
+
+  Pico.m.scanline = y;
+  pv->v_counter = PicoVideoGetV(y, 1);
+
+  Pico.t.m68c_line_start = Pico.t.m68c_aim;
+  Pico.t.batch_end = y + count;
+  do_timing_hacks_start(pv);
+  CPUS_RUN(cycles);
+  if (Pico.t.batch_end) {
+    batch_sync_lines(Pico.t.m68c_aim);
+    Pico.t.batch_end = 0;
+  }
+
+  do_timing_hacks_end(pv);
+
+  pevt_log_m68k_o(EVT_NEXT_LINE);
+  return Pico.m.scanline - y + 1;
+}
+#endif
+
 static int PicoFrameHints(void)
 {
   struct PicoVideo *pv = &Pico.video;
@@ -280,6 +363,13 @@ static int PicoFrameHints(void)
   lines = Pico.m.pal ? 313 : 262;
   for (y++; y < lines - 1; y++)
   {
+#ifdef CPUS_BATCH
+    if (y < lines - 2 && lines_quiet(pv)) {
+      y += run_lines_batched(pv, y, lines - 1 - y) - 1;
+      continue;
+    }
+#endif
+
     Pico.m.scanline = y;
     pv->v_counter = PicoVideoGetV(y, 1);
 
@@ -359,5 +449,6 @@ static int PicoFrameHints(void)
 }
 
 #undef CPUS_RUN
+#undef CPUS_BATCH
 
 // vim:shiftwidth=2:ts=2:expandtab
@@ -456,6 +456,7 @@ struct PicoTiming
   unsigned int m68c_frame_start;        // m68k cycles
   unsigned int m68c_line_start;
   int refresh_delay;
+  int batch_end;                        // end line of a batched run, or 0
 
   unsigned int z80c_cnt;                // z80 cycles done (this frame)
   unsigned int z80c_aim;
@@ -827,6 +828,7 @@ extern void (*PicoLineHook)(void);
 PICO_INTERNAL int  CheckDMA(int cycles);
 PICO_INTERNAL void PicoDetectRegion(void);
 PICO_INTERNAL void PicoSyncZ80(unsigned int m68k_cycles_done);
+void PicoBatchEnd(void);
 
 // cd/mcd.c
 #define PCDS_IEN1     (1<<1)
@@ -988,6 +990,7 @@ void PicoVideoFIFOSync(int cycles);
 int PicoVideoFIFOHint(void);
 void PicoVideoFIFOMode(int active, int h40);
 int PicoVideoFIFOWrite(int count, int byte_p, unsigned sr_mask, unsigned sr_flags);
+int PicoVideoFIFOIdle(void);
 void PicoVideoInit(void);
 void PicoVideoReset(void);
 void PicoVideoTriggerTH(int x, int y);
@@ -996,6 +999,20 @@ int PicoVideoSave(void *buf);
 void PicoVideoLoad(void *buf, int len);
 void PicoVideoCacheSAT(int load);
 
+// events.c
+#define PICO_EVENTS_MAX 8
+struct pico_events {
+  unsigned int *times;          // per event, 0 if not scheduled
+  int size;                     // number of events
+  int count;                    // number of scheduled events
+  unsigned int next;            // time of next event, 0 if none
+  unsigned char heap[PICO_EVENTS_MAX];
+  unsigned char pos[PICO_EVENTS_MAX];   // heap index+1, 0 if not scheduled
+};
+void pico_events_rebuild(struct pico_events *ev);
+void pico_event_set(struct pico_events *ev, int event, unsigned int when);
+int  pico_event_pop(struct pico_events *ev, unsigned int until, unsigned int *when);
+
 // misc.c
 PICO_INTERNAL_ASM void memcpy16bswap(unsigned short *dest, void *src, int count);
 PICO_INTERNAL_ASM void memset32(void *dest, int c, int count);
@@ -1111,6 +1128,7 @@ void *p32x_sh2_get_mem_ptr(u32 a, u32 *mask, SH2 *sh2);
 int p32x_sh2_mem_is_rom(u32 a, SH2 *sh2);
 void p32x_sh2_poll_detect(u32 a, SH2 *sh2, u32 flags, int maxcnt);
 void p32x_sh2_poll_event(u32 a, SH2 *sh2, u32 flags, u32 m68k_cycles);
+int p32x_sh2_write16_block(u32 dst, const u16 *src, int count, SH2 *sh2);
 int p32x_sh2_memcpy(u32 dst, u32 src, int count, int size, SH2 *sh2);
 
 // 32x/draw.c
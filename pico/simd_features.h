@@ -0,0 +1,30 @@
+#ifndef __SIMD_FEATURES_H__
+#define __SIMD_FEATURES_H__
+
+/*
+ * Generic SIMD kernels, written with GCC/clang vector extensions so that the
+ * compiler maps them to whatever the target has. They are used for the
+ * WebAssembly SIMD128 build (emcc -msimd128), which lacks the ARM asm paths,
+ * and can be forced for other targets by defining USE_SIMD.
+ */
+#if defined(__wasm_simd128__) || defined(USE_SIMD)
+#define HAVE_SIMD
+
+/* the aligned attribute allows unaligned memory access through these */
+typedef u8  u8x8  __attribute__((vector_size(8), aligned(1)));
+typedef u32 u32x2 __attribute__((vector_size(8), aligned(4)));
+typedef s32 s32x2 __attribute__((vector_size(8), aligned(4)));
+typedef u32 u32x4 __attribute__((vector_size(16), aligned(4)));
+typedef s32 s32x4 __attribute__((vector_size(16), aligned(4)));
+
+#ifdef __clang__
+#define SIMD_SHUFFLE8(v, a,b,c,d,e,f,g,h) \
+  __builtin_shufflevector(v, v, a,b,c,d,e,f,g,h)
+#else
+#define SIMD_SHUFFLE8(v, a,b,c,d,e,f,g,h) \
+  __builtin_shuffle(v, (u8x8){a,b,c,d,e,f,g,h})
+#endif
+
+#endif
+
+#endif /* __SIMD_FEATURES_H__ */
@@ -9,6 +9,7 @@
 
 #include <string.h>
 #include "../pico_int.h"
+#include "../simd_features.h"
 
 #define MAXOUT		(+32767)
 #define MINOUT		(-32768)
@@ -83,6 +84,42 @@ static inline int filter_null(struct iir *fi2, int x)
 	lfi2 = lf, rfi2 = rf;					\
 }
 
+#ifdef HAVE_SIMD
+// same as above, with both channels processed in one vector
+#define mix_32_to_16_stereo_core_v(dest, src, count, lv) {	\
+	s32x2 y0 = { lfi2.y[0], rfi2.y[0] };			\
+	s32x2 y1 = { lfi2.y[1], rfi2.y[1] };			\
+	s32x2 v, lo, hi;					\
+	int alpha = lfi2.alpha;					\
+								\
+	for (; count > 0; count--, dest += 2, src += 2)		\
+	{							\
+		v = (s32x2){ dest[0], dest[1] };		\
+		v += *(s32x2 *)src >> lv;			\
+		/* filter_band */				\
+		y0 += (v - (y0>>QB)) * alpha;			\
+		y1 += (y0 - y1) >> 9;				\
+		v = (y0 - y1) >> QB;				\
+		/* Limit16 */					\
+		v -= v >> 3;					\
+		lo = v < MINOUT, hi = v > MAXOUT;		\
+		v = (v & ~(lo|hi)) | (MINOUT & lo) | (MAXOUT & hi); \
+		dest[0] = v[0], dest[1] = v[1];			\
+	}							\
+	lfi2.y[0] = y0[0], rfi2.y[0] = y0[1];			\
+	lfi2.y[1] = y1[0], rfi2.y[1] = y1[1];			\
+}
+
+void mix_32_to_16_stereo_lvl(s16 *dest, s32 *src, int count)
+{
+	mix_32_to_16_stereo_core_v(dest, src, count, mix_32_to_16_level);
+}
+
+void mix_32_to_16_stereo(s16 *dest, s32 *src, int count)
+{
+	mix_32_to_16_stereo_core_v(dest, src, count, 0);
+}
+#else
 void mix_32_to_16_stereo_lvl(s16 *dest, s32 *src, int count)
 {
 	mix_32_to_16_stereo_core(dest, src, count, mix_32_to_16_level, filter);
@@ -92,6 +129,7 @@ void mix_32_to_16_stereo(s16 *dest, s32 *src, int count)
 {
 	mix_32_to_16_stereo_core(dest, src, count, 0, filter);
 }
+#endif
 
 void mix_32_to_16_mono(s16 *dest, s32 *src, int count)
 {
@@ -44,6 +44,7 @@
 #include <math.h>
 
 #include "../pico_types.h"
+#include "../simd_features.h"
 #include "resampler.h"
 
 #ifndef M_PI
@@ -228,9 +229,17 @@ void resampler_update(resampler_t *rs, s32 *buffer, int length,
       /* compute filter output */
       s32 *h = p;
       u = rs->filter + (rs->phase * rs->taps);
+#ifdef HAVE_SIMD
+      /* 2 taps of interleaved l/r per vector */
+      s32x4 acc = { 0 };
+      for (i = rs->taps-1; i > 0; i -= 2, u += 2, h += 4)
+        acc += (s32x4){ u[0], u[0], u[1], u[1] } * *(s32x4 *)h;
+      l = acc[0] + acc[2], r = acc[1] + acc[3];
+#else
       for (i = rs->taps-1, l = r = 0; i > 0; i -= 2)
         { n = *u++; l += n * *h++; r += n * *h++;  
           n = *u++; l += n * *h++; r += n * *h++; }
+#endif
       if (i == 0)
         { n = *u++; l += n * *h++; r += n * *h++; }
       *q++ = l >> 15, *q++ = r >> 15;
@@ -248,9 +257,19 @@ void resampler_update(resampler_t *rs, s32 *buffer, int length,
       /* compute filter output */
       s32 *h = p;
       u = rs->filter + (rs->phase * rs->taps);
+#ifdef HAVE_SIMD
+      /* 4 taps per vector */
+      s32x4 acc = { 0 };
+      for (i = rs->taps-1; i > 2; i -= 4, u += 4, h += 4)
+        acc += (s32x4){ u[0], u[1], u[2], u[3] } * *(s32x4 *)h;
+      for (l = acc[0] + acc[1] + acc[2] + acc[3]; i > 0; i -= 2)
+        { n = *u++; l += n * *h++;
+          n = *u++; l += n * *h++; }
+#else
       for (i = rs->taps-1, l = r = 0; i > 0; i -= 2)
         { n = *u++; l += n * *h++;
           n = *u++; l += n * *h++; }
+#endif
       if (i == 0)
         { n = *u++; l += n * *h++; }
       *q++ = l >> 15;
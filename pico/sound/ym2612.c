@@ -1973,37 +1973,6 @@ int YM2612Write_(unsigned int a, unsigned int v)
 	return ret;
 }
 
-#if 0
-UINT8 YM2612Read_(void)
-{
-	return ym2612.OPN.ST.status;
-}
-
-int YM2612PicoTick_(int n)
-{
-	int ret = 0;
-
-	// timer A
-	if(ym2612.OPN.ST.mode & 0x01 && (ym2612.OPN.ST.TAT+=64*n) >= ym2612.OPN.ST.TAC) {
-		ym2612.OPN.ST.TAT -= ym2612.OPN.ST.TAC;
-		if(ym2612.OPN.ST.mode & 0x04) ym2612.OPN.ST.status |= 1;
-		// CSM mode total level latch and auto key on
-		if(ym2612.OPN.ST.mode & 0x80) {
-			CSMKeyControll( &(ym2612.CH[2]) ); // Vectorman2, etc.
-			ret = 1;
-		}
-	}
-
-	// timer B
-	if(ym2612.OPN.ST.mode & 0x02 && (ym2612.OPN.ST.TBT+=64*n) >= ym2612.OPN.ST.TBC) {
-		ym2612.OPN.ST.TBT -= ym2612.OPN.ST.TBC;
-		if(ym2612.OPN.ST.mode & 0x08) ym2612.OPN.ST.status |= 2;
-	}
-
-	return ret;
-}
-#endif
-
 void YM2612PicoStateLoad_(void)
 {
 	reset_channels( &ym2612.CH[0] );
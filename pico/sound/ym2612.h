@@ -179,7 +179,6 @@ int  YM2612UpdateOne_(s32 *buffer, int length, int stereo, int is_buf_empty);
 int  YM2612Write_(unsigned int a, unsigned int v);
 //unsigned char YM2612Read_(void);
 
-int  YM2612PicoTick_(int n);
 void YM2612PicoStateLoad_(void);
 
 void *YM2612GetRegs(void);
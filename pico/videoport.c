@@ -209,6 +209,10 @@ static struct VdpFIFO {
 enum { FQ_BYTE = 1, FQ_BGDMA = 2, FQ_FGDMA = 4 }; // queue flags, NB: BYTE = 1!
 
 
+// catch up with a batched CPU run before looking at the VDP state
+#define VideoBatchEnd() \
+  if (unlikely(Pico.t.batch_end)) PicoBatchEnd()
+
 // NB should limit cyc2sl to table size in case 68k overdraws its aim. That can
 // happen if the last op is a blocking acess to VDP, or for exceptions (e.g.irq)
 #define Cyc2Sl(vf,lc)   ((vf)->fifo_cyc2sl[(lc)/clkdiv])
@@ -392,6 +396,13 @@ int PicoVideoFIFOWrite(int count, int flags, unsigned sr_mask,unsigned sr_flags)
   return burn;
 }
 
+// FIFO has no pending transfers and the CPU isn't waiting for it
+int PicoVideoFIFOIdle(void)
+{
+  return !VdpFIFO.fifo_ql &&
+    !(Pico.video.status & (SR_DMA|PVS_CPUWR|PVS_CPURD));
+}
+
 // at HINT, advance FIFO to new scanline
 int PicoVideoFIFOHint(void)
 {
@@ -527,6 +538,19 @@ static int GetDmaLength(void)
   return len;
 }
 
+// update the SAT cache after a bulk VRAM write of bytes a..e
+static void DmaUpdateSAT(u32 a, u32 e)
+{
+  u32 lo = SATaddr & SATmask, hi = lo + ~SATmask;
+
+  if (e < lo || a > hi)
+    return;
+  if (a < lo) a = lo;
+  if (e > hi) e = hi;
+  for (a &= ~1; a <= e; a += 2)
+    UpdateSAT(a, PicoMem.vram[(u16)a >> 1]);
+}
+
 static void DmaSlow(int len, u32 source)
 {
   struct PicoVideo *pvid=&Pico.video;
@@ -598,13 +622,17 @@ static void DmaSlow(int len, u32 source)
     case 1: // vram
       e = a + len*2-1;
       r = PicoMem.vram;
-      if (inc == 2 && !(a & 1) && !((a ^ e) >> 16) &&
-          ((a >= SATaddr + 0x280) | (e < SATaddr)) &&
-          !((source ^ (source + len-1)) & ~mask))
+      if (inc == 2 && !(a & 1) && !((a ^ e) >> 16))
       {
-        // most used DMA mode
-        memcpy((char *)r + (u16)a, base + (source & mask), len * 2);
-        a += len * 2;
+        // most used DMA mode. Copy in chunks not wrapping in the source
+        u32 s = a;
+        while (len) {
+          int n = mask+1 - (source & mask);
+          if (n > len) n = len;
+          memcpy((char *)r + (u16)a, base + (source & mask), n * 2);
+          source += n, a += n * 2, len -= n;
+        }
+        DmaUpdateSAT(s, e);
         break;
       }
       for(; len; len--)
@@ -618,10 +646,10 @@ static void DmaSlow(int len, u32 source)
       break;
 
     case 3: // cram
-      Pico.m.dirtyPal = 1;
       r = PicoMem.cram;
       if (inc == 0 && !(pvid->reg[1] & 0x40) &&
             (pvid->reg[7] & 0x3f) == ((a/2) & 0x3f)) { // bg color DMA
+        Pico.m.dirtyPal = 1;
         PicoVideoSync(1);
         int sl = VdpFIFO.fifo_hcounts[lc/clkdiv];
         if (sl > VdpFIFO.fifo_hcounts[0]-5) // hint delay is 5 slots
@@ -636,7 +664,12 @@ static void DmaSlow(int len, u32 source)
       }
       for (; len; len--)
       {
-        r[(a / 2) & 0x3f] = base[source++ & mask] & 0xeee;
+        u16 d = base[source++ & mask] & 0xeee;
+        // only invalidate the palette if it's actually changed
+        if (r[(a / 2) & 0x3f] != d) {
+          r[(a / 2) & 0x3f] = d;
+          Pico.m.dirtyPal = 1;
+        }
         // AutoIncrement
         a = (a+inc) & ~0x20000;
       }
@@ -885,6 +918,8 @@ PICO_INTERNAL_ASM void PicoVideoWrite(u32 a,unsigned short d)
 {
   struct PicoVideo *pvid=&Pico.video;
 
+  VideoBatchEnd();
+
   //elprintf(EL_STATUS, "PicoVideoWrite [%06x] %04x [%u] @ %06x",
   //  a, d, SekCyclesDone(), SekPc);
 
@@ -1108,6 +1143,8 @@ static u32 VideoSr(const struct PicoVideo *pv)
 PICO_INTERNAL_ASM u32 PicoVideoRead(u32 a)
 {
   struct PicoVideo *pv = &Pico.video;
+
+  VideoBatchEnd();
   a &= 0x1c;
 
   if (a == 0x04) // control port
@@ -1163,18 +1200,23 @@ PICO_INTERNAL_ASM u32 PicoVideoRead(u32 a)
 
 unsigned char PicoVideoRead8DataH(int is_from_z80)
 {
+  VideoBatchEnd();
   return VideoRead(is_from_z80) >> 8;
 }
 
 unsigned char PicoVideoRead8DataL(int is_from_z80)
 {
+  VideoBatchEnd();
   return VideoRead(is_from_z80);
 }
 
 unsigned char PicoVideoRead8CtlH(int is_from_z80)
 {
   struct PicoVideo *pv = &Pico.video;
-  u8 d = VideoSr(pv) >> 8;
+  u8 d;
+
+  VideoBatchEnd();
+  d = VideoSr(pv) >> 8;
   if (pv->pending) {
     CommandChange(pv);
     pv->pending = 0;
@@ -1186,7 +1228,10 @@ unsigned char PicoVideoRead8CtlH(int is_from_z80)
 unsigned char PicoVideoRead8CtlL(int is_from_z80)
 {
   struct PicoVideo *pv = &Pico.video;
-  u8 d = VideoSr(pv);
+  u8 d;
+
+  VideoBatchEnd();
+  d = VideoSr(pv);
   if (pv->pending) {
     CommandChange(pv);
     pv->pending = 0;
@@ -1197,7 +1242,10 @@ unsigned char PicoVideoRead8CtlL(int is_from_z80)
 
 unsigned char PicoVideoRead8HV_H(int is_from_z80)
 {
-  u32 d = Pico.video.v_counter;
+  u32 d;
+
+  VideoBatchEnd();
+  d = Pico.video.v_counter;
   if (Pico.video.reg[0]&2)
     d = Pico.video.hv_latch >> 8;
   elprintf(EL_HVCNT, "vcounter: %02x [%u] @ %06x", d, SekCyclesDone(), SekPc);
@@ -1207,7 +1255,10 @@ unsigned char PicoVideoRead8HV_H(int is_from_z80)
 // FIXME: broken
 unsigned char PicoVideoRead8HV_L(int is_from_z80)
 {
-  u32 d = SekCyclesDone() - Pico.t.m68c_line_start;
+  u32 d;
+
+  VideoBatchEnd();
+  d = SekCyclesDone() - Pico.t.m68c_line_start;
   if (Pico.video.reg[0]&2)
        d = Pico.video.hv_latch;
   else d = VdpFIFO.fifo_hcounts[d/clkdiv];
@@ -26,6 +26,10 @@ SRCS_COMMON += $(R)cpu/debug.c
  ifeq "$(pdb_net)" "1"
  DEFINES += PDB_NET
  endif
+ ifeq "$(pdb_trace)" "1"
+ DEFINES += PDB_TRACE
+ LDFLAGS += -lpthread
+ endif
  ifeq "$(readline)" "1"
  DEFINES += HAVE_READLINE
  LDFLAGS += -lreadline
@@ -89,7 +93,8 @@ SRCS_COMMON += $(R)pico/pico.c $(R)pico/cart.c $(R)pico/memory.c \
 	$(R)pico/state.c $(R)pico/sek.c $(R)pico/z80if.c \
 	$(R)pico/videoport.c $(R)pico/draw2.c $(R)pico/draw.c \
 	$(R)pico/mode4.c $(R)pico/misc.c $(R)pico/eeprom.c \
-	$(R)pico/patch.c $(R)pico/debug.c $(R)pico/media.c
+	$(R)pico/patch.c $(R)pico/debug.c $(R)pico/media.c \
+	$(R)pico/events.c
 # SMS
 ifneq "$(no_sms)" "1"
 SRCS_COMMON += $(R)pico/sms.c
@@ -11,9 +11,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
-#ifdef __GP2X__
+#if defined(__GP2X__) || defined(__linux__)
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/wait.h>
+#endif
 
 #include "../libpicofe/posix.h"
 #include "../libpicofe/input.h"
@@ -30,6 +33,7 @@
 
 #include <pico/pico_int.h>
 #include <pico/patch.h>
+#include <pico/state.h>
 
 #if defined(__GNUC__) && __GNUC__ >= 7
 #pragma GCC diagnostic ignored "-Wformat-truncation"
@@ -405,6 +409,383 @@ static void do_region_override(const char *media_fname)
 	if (!ret) emu_read_config(NULL, 0);
 }
 
+static const char *movie_load(const char *fname)
+{
+	FILE *movie_file = fopen(fname, "rb");
+	int dummy;
+
+	if (!movie_file)
+		return "Failed to open movie.";
+	fseek(movie_file, 0, SEEK_END);
+	movie_size = ftell(movie_file);
+	fseek(movie_file, 0, SEEK_SET);
+	if (movie_size < 64+3) {
+		fclose(movie_file);
+		return "Invalid GMV file.";
+	}
+	movie_data = malloc(movie_size);
+	if (movie_data == NULL) {
+		fclose(movie_file);
+		return "low memory.";
+	}
+	dummy = fread(movie_data, 1, movie_size, movie_file);
+	fclose(movie_file);
+	if (strncmp((char *)movie_data, "Gens Movie TEST", 15) != 0)
+		return "Invalid GMV file.";
+	(void)dummy;
+	return NULL;
+}
+
+static void movie_prepare(void)
+{
+	enum input_device indev = (movie_data[0x14] == '6') ?
+		PICO_INPUT_PAD_6BTN : PICO_INPUT_PAD_3BTN;
+	PicoSetInputDevice(0, indev);
+	PicoSetInputDevice(1, indev);
+
+	PicoIn.opt |= POPT_DIS_VDP_FIFO; // no VDP fifo timing
+	if (movie_data[0xF] >= 'A') {
+		if (movie_data[0x16] & 0x80) {
+			PicoIn.regionOverride = 8;
+		} else {
+			PicoIn.regionOverride = 4;
+		}
+		PicoReset();
+		// TODO: bits 6 & 5
+	}
+	movie_data[0x18+30] = 0;
+}
+
+/*
+ * PicoDrive movie (.pdm): recorded input with periodic savestate keyframes,
+ * so that playback can seek to any frame without replaying from the start.
+ * All values are little endian. The file layout is:
+ *   header:    "PDMOVIE\x1a", version, frame count, keyframe interval,
+ *              keyframe count, input offset, index offset, 2 input devices
+ *   keyframes: savestates as written by PicoState
+ *   input:     pad[0-3] (u16 each) for every frame
+ *   index:     offset and size of every keyframe
+ * Keyframe n holds the state before frame n*interval is run. Keyframe 0 is
+ * written when recording starts, so a movie needn't start at power on.
+ */
+#define PDM_MAGIC        "PDMOVIE\x1a"
+#define PDM_VERSION      1
+#define PDM_HDR_SIZE     40
+#define PDM_KEY_INTERVAL 600 // frames
+
+static struct {
+	FILE *f;
+	int recording;
+	unsigned int frame, frames;   // next frame to run, frame count
+	unsigned int interval, keys;  // keyframe interval and count
+	unsigned int input_alloc, index_alloc;
+	u16 *input;                   // 4 pads per frame
+	u32 *index;                   // offset, size per keyframe
+	u8 dev0, dev1;
+} pdm;
+
+struct pdm_buf {
+	u8 *data;
+	size_t size, pos;
+};
+
+static size_t pdm_buf_read(void *p, size_t size, size_t n, void *file)
+{
+	struct pdm_buf *b = file;
+	size_t len = size * n;
+
+	if (size == 0)
+		return 0;
+	if (len > b->size - b->pos)
+		len = b->size - b->pos;
+	memcpy(p, b->data + b->pos, len);
+	b->pos += len;
+	return len / size;
+}
+
+static size_t pdm_buf_eof(void *file)
+{
+	struct pdm_buf *b = file;
+	return b->pos >= b->size;
+}
+
+static int pdm_buf_seek(void *file, long offset, int whence)
+{
+	struct pdm_buf *b = file;
+
+	switch (whence) {
+	case SEEK_SET: b->pos = offset; break;
+	case SEEK_CUR: b->pos += offset; break;
+	case SEEK_END: b->pos = b->size + offset; break;
+	}
+	if (b->pos > b->size)
+		b->pos = b->size;
+	return 0;
+}
+
+// convert between native and file byte order
+static void pdm_swab16(u16 *p, unsigned int count)
+{
+	if (!CPU_IS_LE)
+		for (; count > 0; count--, p++)
+			*p = (*p >> 8) | (*p << 8);
+}
+
+static void pdm_swab32(u32 *p, unsigned int count)
+{
+	if (!CPU_IS_LE)
+		for (; count > 0; count--, p++)
+			*p = (*p >> 24) | ((*p >> 8) & 0xff00) |
+			     ((*p << 8) & 0xff0000) | (*p << 24);
+}
+
+static void pdm_free(void)
+{
+	if (pdm.f)
+		fclose(pdm.f);
+	free(pdm.input);
+	free(pdm.index);
+	memset(&pdm, 0, sizeof(pdm));
+}
+
+static int pdm_write_key(void)
+{
+	long offs;
+
+	if (pdm.keys >= pdm.index_alloc) {
+		unsigned int alloc = pdm.index_alloc ? pdm.index_alloc * 2 : 64;
+		u32 *index = realloc(pdm.index, alloc * 2 * sizeof(*index));
+		if (index == NULL)
+			return -1;
+		pdm.index = index;
+		pdm.index_alloc = alloc;
+	}
+
+	offs = ftell(pdm.f);
+	if (PicoStateFP(pdm.f, 1, NULL, (arearw *) fwrite, NULL, (areaseek *) fseek))
+		return -1;
+	pdm.index[pdm.keys*2  ] = offs;
+	pdm.index[pdm.keys*2+1] = ftell(pdm.f) - offs;
+	pdm.keys++;
+	return 0;
+}
+
+static int pdm_load_key(unsigned int key)
+{
+	struct pdm_buf b = { NULL, pdm.index[key*2+1], 0 };
+	int ret = -1;
+
+	b.data = malloc(b.size);
+	if (b.data != NULL && fseek(pdm.f, pdm.index[key*2], SEEK_SET) == 0 &&
+	    fread(b.data, 1, b.size, pdm.f) == b.size)
+		ret = PicoStateFP(&b, 0, pdm_buf_read, NULL, pdm_buf_eof, pdm_buf_seek);
+	free(b.data);
+
+	if (ret == 0)
+		pdm.frame = key * pdm.interval;
+	return ret;
+}
+
+// check that count items of size bytes at offs are within the file
+static int pdm_fits(u32 offs, u32 count, size_t size, long fsize)
+{
+	return offs >= PDM_HDR_SIZE && offs <= (unsigned long)fsize &&
+		count <= ((unsigned long)fsize - offs) / size;
+}
+
+static const char *pdm_open(const char *fname)
+{
+	u8 hdr[PDM_HDR_SIZE];
+	u32 input_offs, index_offs;
+	size_t b = 8, input_size, index_size;
+	unsigned int i;
+	long fsize;
+
+	pdm_free();
+	pdm.f = fopen(fname, "rb");
+	if (pdm.f == NULL)
+		return "Failed to open movie.";
+	if (fread(hdr, 1, sizeof(hdr), pdm.f) != sizeof(hdr) ||
+	    memcmp(hdr, PDM_MAGIC, 8) != 0 || load_u32(hdr, &b) != PDM_VERSION)
+		goto bad;
+
+	pdm.frames   = load_u32(hdr, &b);
+	pdm.interval = load_u32(hdr, &b);
+	pdm.keys     = load_u32(hdr, &b);
+	input_offs   = load_u32(hdr, &b);
+	index_offs   = load_u32(hdr, &b);
+	pdm.dev0     = load_u8_(hdr, &b);
+	pdm.dev1     = load_u8_(hdr, &b);
+	if (pdm.interval == 0 || pdm.keys == 0 ||
+	    pdm.keys > pdm.frames / pdm.interval + 1)
+		goto bad;
+
+	// don't trust the header, everything must be within the file
+	if (fseek(pdm.f, 0, SEEK_END) != 0 || (fsize = ftell(pdm.f)) < 0)
+		goto bad;
+	if (!pdm_fits(input_offs, pdm.frames, 4 * sizeof(*pdm.input), fsize) ||
+	    !pdm_fits(index_offs, pdm.keys, 2 * sizeof(*pdm.index), fsize))
+		goto bad;
+	input_size = (size_t)pdm.frames * 4 * sizeof(*pdm.input);
+	index_size = (size_t)pdm.keys * 2 * sizeof(*pdm.index);
+	if (input_size / (4 * sizeof(*pdm.input)) != pdm.frames ||
+	    index_size / (2 * sizeof(*pdm.index)) != pdm.keys)
+		goto bad;
+
+	pdm.input = malloc(input_size + 1);
+	pdm.index = malloc(index_size);
+	if (pdm.input == NULL || pdm.index == NULL) {
+		pdm_free();
+		return "low memory.";
+	}
+	if (fseek(pdm.f, input_offs, SEEK_SET) != 0 ||
+	    fread(pdm.input, 1, input_size, pdm.f) != input_size ||
+	    fseek(pdm.f, index_offs, SEEK_SET) != 0 ||
+	    fread(pdm.index, 1, index_size, pdm.f) != index_size)
+		goto bad;
+	pdm_swab16(pdm.input, pdm.frames * 4);
+	pdm_swab32(pdm.index, pdm.keys * 2);
+
+	for (i = 0; i < pdm.keys; i++)
+		if (pdm.index[i*2+1] == 0 ||
+		    !pdm_fits(pdm.index[i*2], 1, pdm.index[i*2+1], fsize))
+			goto bad;
+	return NULL;
+
+bad:
+	pdm_free();
+	return "Invalid PDM file.";
+}
+
+// record or play back the input for the next frame
+static void pdm_update(void)
+{
+	u16 *in;
+
+	if (pdm.recording) {
+		if (pdm.frame > 0 && pdm.frame % pdm.interval == 0 &&
+		    pdm_write_key() != 0)
+			goto fail;
+		if (pdm.frame >= pdm.input_alloc) {
+			unsigned int alloc = pdm.input_alloc ? pdm.input_alloc * 2 : 3600;
+			in = realloc(pdm.input, alloc * 4 * sizeof(*in));
+			if (in == NULL)
+				goto fail;
+			pdm.input = in;
+			pdm.input_alloc = alloc;
+		}
+		memcpy(pdm.input + pdm.frame*4, PicoIn.pad, 4 * sizeof(*in));
+		pdm.frames = ++pdm.frame;
+	}
+	else if (pdm.frame < pdm.frames) {
+		memcpy(PicoIn.pad, pdm.input + pdm.frame*4, 4 * sizeof(*in));
+		pdm.frame++;
+	}
+	else {
+		pdm_free();
+		emu_status_msg("END OF MOVIE.");
+		lprintf("END OF MOVIE.\n");
+	}
+	return;
+
+fail:
+	emu_movie_stop();
+	emu_status_msg("MOVIE RECORDING FAILED");
+}
+
+int emu_movie_record(const char *fname)
+{
+	u8 hdr[PDM_HDR_SIZE] = { 0, };
+
+	emu_movie_stop();
+	pdm.f = fopen(fname, "wb");
+	if (pdm.f == NULL)
+		return -1;
+	pdm.recording = 1;
+	pdm.interval = PDM_KEY_INTERVAL;
+	pdm.dev0 = currentConfig.input_dev0;
+	pdm.dev1 = currentConfig.input_dev1;
+
+	if (fwrite(hdr, 1, sizeof(hdr), pdm.f) != sizeof(hdr) || pdm_write_key()) {
+		pdm_free();
+		return -1;
+	}
+	emu_status_msg("RECORDING MOVIE");
+	return 0;
+}
+
+void emu_movie_stop(void)
+{
+	u8 hdr[PDM_HDR_SIZE] = PDM_MAGIC;
+	u32 input_offs, index_offs;
+	size_t b = 8;
+	int ok;
+
+	if (pdm.f == NULL || !pdm.recording) {
+		pdm_free();
+		return;
+	}
+
+	pdm_swab16(pdm.input, pdm.frames * 4);
+	pdm_swab32(pdm.index, pdm.keys * 2);
+	input_offs = ftell(pdm.f);
+	ok = fwrite(pdm.input, 4 * sizeof(*pdm.input), pdm.frames, pdm.f) == pdm.frames;
+	index_offs = ftell(pdm.f);
+	ok = ok && fwrite(pdm.index, 2 * sizeof(*pdm.index), pdm.keys, pdm.f) == pdm.keys;
+
+	save_u32(hdr, &b, PDM_VERSION);
+	save_u32(hdr, &b, pdm.frames);
+	save_u32(hdr, &b, pdm.interval);
+	save_u32(hdr, &b, pdm.keys);
+	save_u32(hdr, &b, input_offs);
+	save_u32(hdr, &b, index_offs);
+	save_u8_(hdr, &b, pdm.dev0);
+	save_u8_(hdr, &b, pdm.dev1);
+	ok = ok && fseek(pdm.f, 0, SEEK_SET) == 0 &&
+		fwrite(hdr, 1, sizeof(hdr), pdm.f) == sizeof(hdr);
+	ok = fclose(pdm.f) == 0 && ok;
+	pdm.f = NULL;
+
+	if (!ok)
+		lprintf("failed to write movie\n");
+	else
+		lprintf("movie saved, %u frames\n", pdm.frames);
+	pdm_free();
+}
+
+// go to the given frame of the movie being played, starting from the nearest
+// keyframe unless the frame can be reached sooner by just running on
+int emu_movie_seek(int frame)
+{
+	unsigned int key;
+	void *set_PsndOut;
+	int set_skip;
+
+	if (pdm.f == NULL || pdm.recording || frame < 0 || frame > pdm.frames)
+		return -1;
+
+	key = frame / pdm.interval;
+	if (key >= pdm.keys)
+		key = pdm.keys - 1;
+	if ((pdm.frame > frame || pdm.frame < key * pdm.interval) &&
+	    pdm_load_key(key) != 0)
+		return -1;
+
+	set_PsndOut = PicoIn.sndOut;
+	set_skip = PicoIn.skipFrame;
+	PicoIn.sndOut = NULL;
+	PicoIn.skipFrame = 1;
+	PicoLoopPrepare();
+	while (pdm.frame < frame) {
+		pdm_update();
+		PicoFrame();
+	}
+	PicoIn.sndOut = set_PsndOut;
+	PicoIn.skipFrame = set_skip;
+	reset_timing = 1;
+	return 0;
+}
+
 int emu_reload_rom(const char *rom_fname_in)
 {
 	// use setting before rom config is loaded
@@ -430,34 +811,31 @@ int emu_reload_rom(const char *rom_fname_in)
 		free(movie_data);
 		movie_data = 0;
 	}
+	emu_movie_stop();
 
 	if (!strcasecmp(ext, ".gmv"))
 	{
 		// check for both gmv and rom
+		const char *err = movie_load(rom_fname);
 		int dummy;
-		FILE *movie_file = fopen(rom_fname, "rb");
-		if (!movie_file) {
-			menu_update_msg("Failed to open movie.");
+		if (err != NULL) {
+			menu_update_msg(err);
 			goto out;
 		}
-		fseek(movie_file, 0, SEEK_END);
-		movie_size = ftell(movie_file);
-		fseek(movie_file, 0, SEEK_SET);
-		if (movie_size < 64+3) {
-			menu_update_msg("Invalid GMV file.");
-			fclose(movie_file);
-			goto out;
-		}
-		movie_data = malloc(movie_size);
-		if (movie_data == NULL) {
-			menu_update_msg("low memory.");
-			fclose(movie_file);
+		dummy = try_rfn_cut(rom_fname) || try_rfn_cut(rom_fname);
+		if (!dummy) {
+			menu_update_msg("Could't find a ROM for movie.");
 			goto out;
 		}
-		dummy = fread(movie_data, 1, movie_size, movie_file);
-		fclose(movie_file);
-		if (strncmp((char *)movie_data, "Gens Movie TEST", 15) != 0) {
-			menu_update_msg("Invalid GMV file.");
+		get_ext(rom_fname, ext);
+		lprintf("gmv loaded for %s\n", rom_fname);
+	}
+	else if (!strcasecmp(ext, ".pdm"))
+	{
+		const char *err = pdm_open(rom_fname);
+		int dummy;
+		if (err != NULL) {
+			menu_update_msg(err);
 			goto out;
 		}
 		dummy = try_rfn_cut(rom_fname) || try_rfn_cut(rom_fname);
@@ -466,7 +844,7 @@ int emu_reload_rom(const char *rom_fname_in)
 			goto out;
 		}
 		get_ext(rom_fname, ext);
-		lprintf("gmv loaded for %s\n", rom_fname);
+		lprintf("pdm loaded for %s\n", rom_fname);
 	}
 	else if (!strcasecmp(ext, ".pat"))
 	{
@@ -520,28 +898,18 @@ int emu_reload_rom(const char *rom_fname_in)
 	// additional movie stuff
 	if (movie_data)
 	{
-		enum input_device indev = (movie_data[0x14] == '6') ?
-			PICO_INPUT_PAD_6BTN : PICO_INPUT_PAD_3BTN;
-		PicoSetInputDevice(0, indev);
-		PicoSetInputDevice(1, indev);
-
-		PicoIn.opt |= POPT_DIS_VDP_FIFO; // no VDP fifo timing
-		if (movie_data[0xF] >= 'A') {
-			if (movie_data[0x16] & 0x80) {
-				PicoIn.regionOverride = 8;
-			} else {
-				PicoIn.regionOverride = 4;
-			}
-			PicoReset();
-			// TODO: bits 6 & 5
-		}
-		movie_data[0x18+30] = 0;
+		movie_prepare();
 		emu_status_msg("MOVIE: %s", (char *) &movie_data[0x18]);
 	}
 	else
 	{
-		PicoSetInputDevice(0, currentConfig.input_dev0);
-		PicoSetInputDevice(1, currentConfig.input_dev1);
+		if (pdm.f) {
+			PicoSetInputDevice(0, pdm.dev0);
+			PicoSetInputDevice(1, pdm.dev1);
+		} else {
+			PicoSetInputDevice(0, currentConfig.input_dev0);
+			PicoSetInputDevice(1, currentConfig.input_dev1);
+		}
 
 		system_announce();
 		PicoIn.opt &= ~POPT_DIS_VDP_FIFO;
@@ -578,6 +946,16 @@ int emu_reload_rom(const char *rom_fname_in)
 		}
 	}
 
+	// the movie starts from its first keyframe
+	if (pdm.f) {
+		if (pdm_load_key(0) != 0) {
+			pdm_free();
+			menu_update_msg("Movie keyframe load failed.");
+			goto out;
+		}
+		emu_status_msg("MOVIE: %u frames", pdm.frames);
+	}
+
 	retval = 1;
 out:
 	if (menu_romload_started)
@@ -1483,6 +1861,8 @@ void emu_update_input(void)
 		run_events_ui(events);
 	if (movie_data)
 		update_movie();
+	else if (pdm.f)
+		pdm_update();
 
 	prev_events = actions[IN_BINDTYPE_EMU] & PEV_MASK;
 }
@@ -1562,6 +1942,8 @@ void emu_init(void)
 
 void emu_finish(void)
 {
+	emu_movie_stop();
+
 	// save SRAM
 	if ((currentConfig.EmuOpt & EOPT_EN_SRAM) && Pico.sv.changed) {
 		emu_save_load_game(0, 1);
@@ -1860,3 +2242,123 @@ void emu_loop(void)
 	emu_sound_stop();
 	plat_grab_cursor(0);
 }
+
+#ifdef __linux__
+/*
+ * fork server: the machine is booted once, and each job is run in a forked
+ * copy of it, sharing all memory copy-on-write. Jobs are read from stdin, one
+ * per line: <movie> <frames> [<savestate>|- [<start>]]. The movie (.gmv or
+ * .pdm) is played without video and sound for <frames> frames, or to its end
+ * if <frames> is <= 0, and the resulting state is saved if a file is given.
+ * .pdm movies can be started at frame <start>, which allows splitting a long
+ * movie into segments. Up to one job per CPU is run at a time, and
+ * "start <pid> <movie>" and "done <pid> <status>" are printed for each job.
+ */
+static void fork_server_job(const char *movie, int frames, const char *state,
+	int start)
+{
+	const char *err;
+	char ext[5];
+	int i, ret = 0;
+
+	get_ext(movie, ext);
+	if (!strcasecmp(ext, ".pdm")) {
+		err = pdm_open(movie);
+		if (err == NULL) {
+			PicoSetInputDevice(0, pdm.dev0);
+			PicoSetInputDevice(1, pdm.dev1);
+			if (pdm_load_key(0) != 0 || emu_movie_seek(start) != 0)
+				err = "Failed to seek movie.";
+		}
+	} else {
+		err = movie_load(movie);
+		if (err == NULL)
+			movie_prepare();
+	}
+	if (err != NULL) {
+		lprintf("%s: %s\n", movie, err);
+		_exit(1);
+	}
+
+	PicoLoopPrepare();
+	PicoIn.sndOut = NULL;
+	PicoIn.skipFrame = 1;
+	for (i = 0; (movie_data != NULL || pdm.f != NULL) &&
+			(frames <= 0 || i < frames); i++) {
+		if (movie_data)
+			update_movie();
+		else
+			pdm_update();
+		PicoFrame();
+	}
+
+	if (state != NULL && PicoState(state, 1) != 0) {
+		lprintf("%s: failed to save %s\n", movie, state);
+		ret = 1;
+	}
+	fflush(stdout);
+	_exit(ret);
+}
+
+static void fork_server_reap(int *running, int block)
+{
+	int status;
+	pid_t pid;
+
+	while (*running > 0 && (pid = waitpid(-1, &status, block ? 0 : WNOHANG)) > 0) {
+		printf("done %d %d\n", (int)pid,
+			WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+		fflush(stdout);
+		(*running)--;
+		block = 0;
+	}
+}
+
+void emu_fork_server(void)
+{
+	char line[1100], movie[512], state[512];
+	long jobs_max = sysconf(_SC_NPROCESSORS_ONLN);
+	int running = 0, frames, start, n;
+	pid_t pid;
+
+	if (jobs_max < 1)
+		jobs_max = 1;
+	if (movie_data) {
+		// the movie given on the command line is not played here
+		free(movie_data);
+		movie_data = NULL;
+	}
+
+	while (fgets(line, sizeof(line), stdin) != NULL)
+	{
+		start = 0;
+		n = sscanf(line, "%511s %d %511s %d", movie, &frames, state, &start);
+		if (n < 2) {
+			if (n > 0)
+				lprintf("forkserver: bad job: %s", line);
+			continue;
+		}
+
+		fork_server_reap(&running, 0);
+		if (running >= jobs_max)
+			fork_server_reap(&running, 1);
+
+		fflush(stdout);
+		fflush(stderr);
+		pid = fork();
+		if (pid == 0)
+			fork_server_job(movie, frames,
+				n > 2 && strcmp(state, "-") ? state : NULL, start);
+		if (pid < 0) {
+			lprintf("forkserver: fork failed\n");
+			continue;
+		}
+		running++;
+		printf("start %d %s\n", (int)pid, movie);
+		fflush(stdout);
+	}
+
+	while (running > 0)
+		fork_server_reap(&running, 1);
+}
+#endif
@@ -146,6 +146,12 @@ int   emu_play_tape(const char *fname);
 int   emu_record_tape(const char *ext);
 int   emu_save_load_game(int load, int sram);
 void  emu_reset_game(void);
+int   emu_movie_record(const char *fname);
+int   emu_movie_seek(int frame);
+void  emu_movie_stop(void);
+#ifdef __linux__
+void  emu_fork_server(void);
+#endif
 
 void  emu_prep_defconfig(void);
 void  emu_set_defconfig(void);
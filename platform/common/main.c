@@ -22,6 +22,11 @@
 #include <cpu/debug.h>
 
 static int load_state_slot = -1;
+static const char *movie_record;
+static int movie_seek;
+#ifdef __linux__
+static int fork_server;
+#endif
 char **g_argv;
 
 void parse_cmd_line(int argc, char *argv[])
@@ -40,12 +45,23 @@ void parse_cmd_line(int argc, char *argv[])
 			{
 				if (x+1 < argc) { ++x; load_state_slot = atoi(argv[x]); }
 			}
+			else if (strcasecmp(argv[x], "-record") == 0) {
+				if (x+1 < argc) { ++x; movie_record = argv[x]; }
+			}
+			else if (strcasecmp(argv[x], "-seek") == 0) {
+				if (x+1 < argc) { ++x; movie_seek = atoi(argv[x]); }
+			}
 			else if (strcasecmp(argv[x], "-pdb") == 0) {
 				if (x+1 < argc) { ++x; pdb_command(argv[x]); }
 			}
 			else if (strcasecmp(argv[x], "-pdb_connect") == 0) {
 				if (x+2 < argc) { pdb_net_connect(argv[x+1], argv[x+2]); x += 2; }
 			}
+#ifdef __linux__
+			else if (strcasecmp(argv[x], "-forkserver") == 0) {
+				fork_server = 1;
+			}
+#endif
 			else {
 				unrecognized = plat_parse_arg(argc, argv, &x);
 			}
@@ -66,7 +82,13 @@ void parse_cmd_line(int argc, char *argv[])
 		printf("usage: %s [options] [romfile]\n", argv[0]);
 		printf("options:\n"
 			" -config <file>    use specified config file instead of default 'config.cfg'\n"
-			" -loadstate <num>  if ROM is specified, try loading savestate slot <num>\n");
+			" -loadstate <num>  if ROM is specified, try loading savestate slot <num>\n"
+			" -record <file>    record input to a .pdm movie\n"
+			" -seek <frame>     if a .pdm movie is specified, start playing at <frame>\n"
+#ifdef __linux__
+			" -forkserver       boot the ROM, then run movie jobs read from stdin\n"
+#endif
+			);
 		exit(1);
 	}
 }
@@ -105,11 +127,23 @@ int main(int argc, char *argv[])
 				state_slot = load_state_slot;
 				emu_save_load_game(1, 0);
 			}
+			if (movie_seek > 0 && emu_movie_seek(movie_seek) != 0)
+				printf("failed to seek to frame %d\n", movie_seek);
+			if (movie_record && emu_movie_record(movie_record) != 0)
+				printf("failed to record movie to %s\n", movie_record);
 		}
 		plat_video_menu_end();
 	}
 	plat_video_menu_leave();
 
+#ifdef __linux__
+	if (fork_server) {
+		if (engineState == PGS_Running)
+			emu_fork_server();
+		goto endloop;
+	}
+#endif
+
 	for (;;)
 	{
 		switch (engineState)
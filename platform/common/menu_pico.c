@@ -912,7 +912,11 @@ static int menu_loop_sms_options(int id, int keys)
 
 static const char h_gglcd[] = "Show full VDP image with borders if disabled";
 static const char h_ovrclk[] = "Will break some games, keep at 0";
+static const char h_z80lazy[] = "Run the Z80 only when the 68k needs it\n"
+				 "faster, but may break sound in some games";
 static const char h_dynarec[] = "Disabling dynarecs massively slows down 32X";
+static const char h_hugepage[] = "Use 2MB pages for the dynarec code cache\n"
+				  "applies when the next game is loaded";
 static const char h_sh2cycles[]  = "Cycles/millisecond (similar to DOSBox)\n"
 				   "lower values speed up emulation but break games\n"
 				   "at least 11000 recommended for compatibility";
@@ -924,7 +928,9 @@ static menu_entry e_menu_adv_options[] =
 	mee_onoff     ("Disable idle loop patching",MA_OPT2_NO_IDLE_LOOPS,PicoIn.opt, POPT_DIS_IDLE_DET),
 	mee_onoff_h   ("Emulate Game Gear LCD",    MA_OPT2_ENABLE_GGLCD  ,PicoIn.opt, POPT_EN_GG_LCD, h_gglcd),
 	mee_range_h   ("Overclock M68k (%)",       MA_OPT2_OVERCLOCK_M68K,currentConfig.overclock_68k, 0, 1000, h_ovrclk),
+	mee_onoff_h   ("Lazy Z80 sync",            MA_OPT2_Z80_LAZY,      PicoIn.opt, POPT_Z80_LAZY_SYNC, h_z80lazy),
 	mee_onoff_h   ("Enable dynarecs",          MA_OPT2_DYNARECS,      PicoIn.opt, POPT_EN_DRC, h_dynarec),
+	mee_onoff_h   ("Dynarec huge pages",       MA_OPT2_DRC_HUGEPAGE,  PicoIn.opt, POPT_EN_DRC_HUGEPAGE, h_hugepage),
 	mee_cust_h    ("Master SH2 cycles",        MA_32XOPT_MSH2_CYCLES, mh_opt_sh2cycles, mgn_opt_sh2cycles, h_sh2cycles),
 	mee_cust_h    ("Slave SH2 cycles",         MA_32XOPT_SSH2_CYCLES, mh_opt_sh2cycles, mgn_opt_sh2cycles, h_sh2cycles),
 	MENU_OPTIONS_ADV
@@ -1112,27 +1118,27 @@ static int mh_profile(int id, int keys) {
 		currentConfig.renderer32x = find_renderer(renderer_names32x, "accurate");
 		PicoIn.sndRate = 44100;
 		PicoIn.opt |= POPT_EN_FM_FILTER | POPT_EN_FM | POPT_EN_MCD_CDDA;
-		PicoIn.opt &= ~POPT_PWM_IRQ_OPT;
+		PicoIn.opt &= ~(POPT_PWM_IRQ_OPT | POPT_Z80_LAZY_SYNC);
 		break;
 	case MA_PROFILE_BALANCED:
 		currentConfig.renderer = find_renderer(renderer_names, "8bit");
 		currentConfig.renderer32x = find_renderer(renderer_names32x, "fast");
 		PicoIn.sndRate = 44100;
 		PicoIn.opt |= POPT_EN_FM | POPT_EN_MCD_CDDA;
-		PicoIn.opt &= ~(POPT_PWM_IRQ_OPT | POPT_EN_FM_FILTER);
+		PicoIn.opt &= ~(POPT_PWM_IRQ_OPT | POPT_EN_FM_FILTER | POPT_Z80_LAZY_SYNC);
 		break;
 	case MA_PROFILE_FAST:
 		currentConfig.renderer = find_renderer(renderer_names, "fast");
 		currentConfig.renderer32x = find_renderer(renderer_names32x, "fastest");
 		PicoIn.sndRate = 22050;
-		PicoIn.opt |= POPT_PWM_IRQ_OPT | POPT_EN_FM | POPT_EN_MCD_CDDA;
+		PicoIn.opt |= POPT_PWM_IRQ_OPT | POPT_Z80_LAZY_SYNC | POPT_EN_FM | POPT_EN_MCD_CDDA;
 		PicoIn.opt &= ~POPT_EN_FM_FILTER;
 		break;
 	case MA_PROFILE_BREAKING:
 		currentConfig.renderer = find_renderer(renderer_names, "fast");
 		currentConfig.renderer32x = find_renderer(renderer_names32x, "fastest");
 		PicoIn.sndRate = 16000;
-		PicoIn.opt |= POPT_PWM_IRQ_OPT;
+		PicoIn.opt |= POPT_PWM_IRQ_OPT | POPT_Z80_LAZY_SYNC;
 		PicoIn.opt &= ~(POPT_EN_FM_FILTER | POPT_EN_FM | POPT_EN_MCD_CDDA);
 		break;
 	}
@@ -1905,6 +1911,10 @@ void menu_init(void)
 	i = 1;
 #endif
 	me_enable(e_menu_adv_options, MA_OPT2_DYNARECS, i);
+#ifndef __linux__
+	i = 0;
+#endif
+	me_enable(e_menu_adv_options, MA_OPT2_DRC_HUGEPAGE, i);
 
 	i = me_id2offset(e_menu_gfx_options, MA_OPT_VOUT_MODE);
 	e_menu_gfx_options[i].data = plat_target.vout_methods;
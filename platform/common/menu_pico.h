@@ -76,6 +76,8 @@ typedef enum
 	MA_OPT2_OVERCLOCK_M68K,
 	MA_OPT2_MAX_FRAMESKIP,
 	MA_OPT2_PWM_IRQ_OPT,
+	MA_OPT2_DRC_HUGEPAGE,
+	MA_OPT2_Z80_LAZY,
 	MA_OPT2_DONE,
 	MA_OPT3_GAMMAA,		/* psp (all OPT3) */
 	MA_OPT3_FILTERING,
@@ -99,6 +99,7 @@ static retro_audio_sample_batch_t audio_batch_cb;
 
 #define SND_RATE_DEFAULT 44100
 #define SND_RATE_MAX     53267
+#define SND_BATCH_MAX    4
 
 #ifndef PATH_MAX
 #define PATH_MAX 4096
@@ -120,6 +121,11 @@ static void *vout_buf, *vout_ghosting_buf;
 static int vout_width, vout_height, vout_offset;
 static float vout_aspect = 0.0;
 static int vout_ghosting = 0;
+/* frontend framebuffer for the current frame, if rendering directly into it */
+static void *vout_fb;
+static int vout_fb_pitch;
+/* vout_buf is older than the last frame shown from the frontend framebuffer */
+static int vout_buf_stale;
 
 static bool libretro_update_av_info = false;
 static bool libretro_update_geometry = false;
@@ -132,9 +138,10 @@ static void *retro_palette;
 static struct retro_hw_ps2_insets padding;
 #endif
 
-static short ALIGNED(4) sndBuffer[2*SND_RATE_MAX/50];
+static short ALIGNED(4) sndBuffer[SND_BATCH_MAX*2*SND_RATE_MAX/50];
 
 static void snd_write(int len);
+static void set_memory_maps(void);
 
 char **g_argv;
 
@@ -159,6 +166,11 @@ static bool retro_audio_buff_underrun      = false;
 
 static unsigned audio_latency              = 0;
 static bool update_audio_latency           = false;
+
+/* Audio batching: frames of sound collected in sndBuffer before
+ * handing them to the frontend. 0 batches only when fast-forwarding */
+static unsigned snd_batch_frames           = 1;
+static unsigned snd_batch_count            = 0;
 static uint16_t pico_events;
 // Sega Pico stuff
 int pico_inp_mode;
@@ -572,6 +584,7 @@ void emu_video_mode_change(int start_line, int line_count, int start_col, int co
       ps2->padding = padding;
    }
 #else
+   vout_fb = NULL;
    vout_width = col_count;
    memset(vout_buf, 0, VOUT_MAX_WIDTH * VOUT_MAX_HEIGHT * 2);  
    if (vout_16bit)
@@ -605,6 +618,9 @@ void emu_32x_startup(void)
    PicoDrawSetOutFormat(vout_format, 0);
    vout_16bit = 1;
 
+   /* 32X memory is only allocated now, announce it */
+   set_memory_maps();
+
    if (vout_buf &&
        (vm_current_start_line != -1) && (vm_current_line_count != -1) &&
        (vm_current_start_col != -1) && (vm_current_col_count != -1))
@@ -1351,24 +1367,84 @@ static const char *find_msu(const char *cd_fname)
    return NULL;
 }
 
+/* 16 bit memories are kept as host order words, which is big endian
+ * with respect to the guest only on big endian hosts */
+#if CPU_IS_LE
+#define MEMDESC_WORDS 0
+#else
+#define MEMDESC_WORDS RETRO_MEMDESC_BIGENDIAN
+#endif
+
+/* byte wide SRAM only connects the odd or even bytes, as told by the
+ * header (0x1b2 bits 4-3: 0 both, 2 even, 3 odd) */
+static int sram_is_byte_wide(void)
+{
+   return Pico.rom != NULL && Pico.romsize > 0x1b3 &&
+      Pico.rom[MEM_BE2(0x1b0)] == 'R' && Pico.rom[MEM_BE2(0x1b1)] == 'A' &&
+      (Pico.rom[MEM_BE2(0x1b2)] & 0x10);
+}
+
 static void set_memory_maps(void)
 {
+   /* virtual address bits for memories outside the main CPU address space */
+   const size_t SCD_BIT = 1ULL << 31ULL;
+   const size_t P32X_BIT = 1ULL << 30ULL;
+   const uint64_t mem = RETRO_MEMDESC_SYSTEM_RAM;
+   const uint64_t sav = RETRO_MEMDESC_SAVE_RAM;
+   struct retro_memory_descriptor descs[10];
+   struct retro_memory_map mmaps;
+   int n = 0;
+
+#define MEMDESC(flags, ptr, start, len, name) \
+   descs[n++] = (struct retro_memory_descriptor) \
+      { flags, ptr, 0, start, 0, 0, len, name }
+
+   if (PicoIn.AHW & PAHW_SMS)
+   {
+      MEMDESC(mem, PicoMem.zram, 0xC000, 0x2000, "Z80RAM");
+      /* banked into 0x8000, published at 0x10000 so it doesn't overlap ROM */
+      if (Pico.sv.data && Pico.sv.size)
+         MEMDESC(sav, Pico.sv.data, 0x10000, Pico.sv.size, "CARTRAM");
+   }
+   else
+   {
+      MEMDESC(mem | MEMDESC_WORDS, PicoMem.ram, 0xFF0000, 0x10000, "68KRAM");
+      MEMDESC(mem, PicoMem.zram, 0xA00000, 0x2000, "Z80RAM");
+      /* EEPROM isn't on the bus. Byte wide SRAM is kept in bus layout with
+       * the unconnected bytes in between, which can't be described */
+      if (Pico.sv.data && Pico.sv.size && !(Pico.sv.flags & SRF_EEPROM) &&
+            !sram_is_byte_wide())
+         MEMDESC(sav, Pico.sv.data, Pico.sv.start, Pico.sv.size, "SRAM");
+   }
+
    if (PicoIn.AHW & PAHW_MCD)
    {
-      const size_t SCD_BIT = 1ULL << 31ULL;
-      const uint64_t mem = RETRO_MEMDESC_SYSTEM_RAM;
-      struct retro_memory_map mmaps;
-      struct retro_memory_descriptor descs[] = {
-         { mem, PicoMem.ram,        0,           0xFF0000, 0, 0, 0x10000, "68KRAM" },
-         /* virtual address using SCD_BIT so all 512M of prg_ram can be accessed */
-         /* at address $80020000 */
-         { mem, Pico_mcd->prg_ram,  0, SCD_BIT | 0x020000, 0, 0, 0x80000, "PRGRAM" },
-      };
+      /* virtual address using SCD_BIT so all 512M of prg_ram can be accessed */
+      /* at address $80020000 */
+      MEMDESC(mem | MEMDESC_WORDS, Pico_mcd->prg_ram,
+            SCD_BIT | 0x020000, 0x80000, "PRGRAM");
+      MEMDESC(mem | MEMDESC_WORDS, Pico_mcd->word_ram2M,
+            SCD_BIT | 0x080000, 0x40000, "WORDRAM");
+   }
 
-      mmaps.descriptors = descs;
-      mmaps.num_descriptors = sizeof(descs) / sizeof(descs[0]);
-      environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &mmaps);
+   if ((PicoIn.AHW & PAHW_32X) && Pico32xMem != NULL)
+   {
+      /* SH2 addresses; the 2nd frame buffer goes to a virtual address.
+       * These are the physical frame buffers, the FS bit selects which
+       * one the SH2s see at 0x04000000 */
+      MEMDESC(mem | MEMDESC_WORDS, Pico32xMem->sdram, 0x06000000, 0x40000, "SDRAM");
+      MEMDESC(RETRO_MEMDESC_VIDEO_RAM | MEMDESC_WORDS, Pico32xMem->dram[0],
+            0x04000000, 0x20000, "DRAM0");
+      MEMDESC(RETRO_MEMDESC_VIDEO_RAM | MEMDESC_WORDS, Pico32xMem->dram[1],
+            P32X_BIT | 0x04000000, 0x20000, "DRAM1");
+      MEMDESC(RETRO_MEMDESC_VIDEO_RAM | MEMDESC_WORDS, Pico32xMem->pal,
+            0x20004200, 0x200, "PAL32X");
    }
+#undef MEMDESC
+
+   mmaps.descriptors = descs;
+   mmaps.num_descriptors = n;
+   environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &mmaps);
 }
 
 bool retro_load_game(const struct retro_game_info *info)
@@ -1637,6 +1713,7 @@ bool retro_load_game(const struct retro_game_info *info)
    PicoIn.writeSound = snd_write;
    memset(sndBuffer, 0, sizeof(sndBuffer));
    PicoIn.sndOut = sndBuffer;
+   snd_batch_count = 0;
    if (PicoIn.sndRate > 52000 && PicoIn.sndRate < 54000)
       PicoIn.sndRate = YM2612_NATIVE_RATE();
    PsndRerate(0);
@@ -1769,9 +1846,36 @@ static const unsigned short retro_pico_map[] = {
 
 static int has_4_pads;
 
+static void snd_flush(void)
+{
+   size_t len = PicoIn.sndOut - sndBuffer;
+
+   if (len)
+      audio_batch_cb(sndBuffer, len / 2);
+   PicoIn.sndOut = sndBuffer;
+   snd_batch_count = 0;
+}
+
 static void snd_write(int len)
 {
-   audio_batch_cb(PicoIn.sndOut, len / 4);
+   short *next = PicoIn.sndOut + len / 2;
+   unsigned frames = snd_batch_frames;
+   bool fastforward = false;
+
+   if (frames == 0)
+      frames = environ_cb(RETRO_ENVIRONMENT_GET_FASTFORWARDING, &fastforward)
+               && fastforward ? SND_BATCH_MAX : 1;
+
+   /* keep collecting as long as another full frame fits behind this one */
+   if (++snd_batch_count < frames &&
+         next + 2*SND_RATE_MAX/50 <= sndBuffer + ARRAY_SIZE(sndBuffer)) {
+      PicoIn.sndOut = next;
+      return;
+   }
+
+   audio_batch_cb(sndBuffer, (next - sndBuffer) / 2);
+   PicoIn.sndOut = sndBuffer;
+   snd_batch_count = 0;
 }
 
 static enum input_device input_name_to_val(const char *name)
@@ -2024,6 +2128,18 @@ static void update_variables(bool first_run)
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
       frameskip_threshold = strtol(var.value, NULL, 10);
 
+   snd_batch_frames = 1;
+   var.value = NULL;
+   var.key = "picodrive_audio_batch";
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+      if (strcmp(var.value, "ff") == 0)
+         snd_batch_frames = 0;
+      else
+         snd_batch_frames = atoi(var.value);
+      if (snd_batch_frames > SND_BATCH_MAX)
+         snd_batch_frames = SND_BATCH_MAX;
+   }
+
    old_vout_format = vout_format;
    var.value = NULL;
    var.key = "picodrive_renderer";
@@ -2047,7 +2163,9 @@ static void update_variables(bool first_run)
       else
          new_sound_rate = atoi(var.value);
       if (new_sound_rate != PicoIn.sndRate) {
-         /* Update the sound rate */
+         /* Update the sound rate, sending out what was recorded at the old one */
+         if (!first_run && PicoIn.sndOut)
+            snd_flush();
          PicoIn.sndRate = new_sound_rate;
          PsndRerate(!first_run);
          libretro_update_av_info = true;
@@ -2318,6 +2436,65 @@ void run_events_pico(unsigned int events)
     PicoPicohw.pen_pos[1] |= (pico_inp_mode == 1 ? 0x2f8 : 0x1fc) + pico_pen_y;
 }
 
+#if !defined(RENDER_GSKIT_PS2)
+/* Try to obtain the frontend's framebuffer for this frame, so that the image
+ * can be produced in place instead of being copied out of vout_buf */
+static void *get_frontend_fb(int *pitch)
+{
+   struct retro_framebuffer fb = { 0 };
+
+   fb.width = vout_width;
+   fb.height = vout_height;
+   /* read back if the next frame needs this image, see vout_lines_retained */
+   fb.access_flags = RETRO_MEMORY_ACCESS_WRITE | RETRO_MEMORY_ACCESS_READ;
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) ||
+         fb.data == NULL || fb.format != RETRO_PIXEL_FORMAT_RGB565 ||
+         fb.width != vout_width || fb.height != vout_height ||
+         fb.pitch < vout_width * 2)
+      return NULL;
+
+   *pitch = fb.pitch;
+   return fb.data;
+}
+
+/* If a frame starts with the display off after it was on, the renderer
+ * retains the previous image in the lines before the display is enabled.
+ * Only vout_buf has that image, the frontend framebuffer may be another one */
+static int vout_lines_retained(void)
+{
+   return !(PicoIn.AHW & (PAHW_32X|PAHW_SMS)) && !(Pico.video.reg[1] & 0x40) &&
+         (Pico.est.rendstatus & PDRAW_DISP_WAS_ON);
+}
+
+static void vout_fb_prepare(void)
+{
+   void *fb = NULL;
+   int pitch = 0;
+
+   /* ghosting and the Pico overlay need the previous image in vout_buf */
+   if (!PicoIn.skipFrame && vm_current_start_line >= 0 &&
+         !(vout_ghosting && vout_height == 144) && !(PicoIn.AHW & PAHW_PICO) &&
+         !vout_lines_retained())
+      fb = get_frontend_fb(&pitch);
+
+   /* the renderer addresses lines starting at vm_current_start_line */
+   if (fb != NULL && vout_16bit) {
+      PicoDrawSetOutBuf((char *)fb - vm_current_start_line * pitch, pitch);
+      /* no previous image in there, all lines must be drawn */
+      Pico.est.rendstatus |= PDRAW_SYNC_NEEDED;
+   } else if (vout_buf_stale && !PicoIn.skipFrame) {
+      /* don't show lines from before the frames rendered to the frontend */
+      if (vout_lines_retained())
+         memset(vout_buf, 0, VOUT_MAX_WIDTH * VOUT_MAX_HEIGHT * 2);
+      Pico.est.rendstatus |= PDRAW_SYNC_NEEDED;
+      vout_buf_stale = 0;
+   }
+
+   vout_fb = fb;
+   vout_fb_pitch = pitch;
+}
+#endif
+
 void retro_run(void)
 {
    bool updated = false;
@@ -2408,6 +2585,9 @@ void retro_run(void)
       update_audio_latency = false;
    }
 
+#if !defined(RENDER_GSKIT_PS2)
+   vout_fb_prepare();
+#endif
    PicoFrame();
 
    /* Check whether frontend needs to be notified
@@ -2430,6 +2610,25 @@ void retro_run(void)
       return;
    }
 
+#if !defined(RENDER_GSKIT_PS2)
+   /* a video mode change in PicoFrame redirects output back to vout_buf */
+   if (vout_fb != NULL && vout_16bit) {
+      /* keep the image in vout_buf if the next frame retains lines of it */
+      if (vout_lines_retained()) {
+         for (i = 0; i < vout_height; i++)
+            memcpy((char *)vout_buf + vout_offset + i * vout_width * 2,
+                  (char *)vout_fb + i * vout_fb_pitch, vout_width * 2);
+         vout_buf_stale = 0;
+      } else
+         vout_buf_stale = 1;
+      video_cb(vout_fb, vout_width, vout_height, vout_fb_pitch);
+      /* the frontend buffer is only valid during this retro_run call */
+      PicoDrawSetOutBuf(vout_buf, vout_width * 2);
+      vout_fb = NULL;
+      return;
+   }
+#endif
+
 #if defined(RENDER_GSKIT_PS2)
    buff = (uint32_t *)RETRO_HW_FRAME_BUFFER_VALID;
 
@@ -2480,10 +2679,16 @@ void retro_run(void)
        */
       /* This section is mostly copied from pemu_finalize_frame in platform/linux/emu.c */
       unsigned short *pd = (unsigned short *)((char *)vout_buf + vout_offset);
+      int pd_pitch = vout_width;
       /* Skip the leftmost 8 columns (it is used as an overlap area for rendering) */
       unsigned char *ps = Pico.est.Draw2FB + vm_current_start_line * 328 + 8;
       unsigned short *pal = Pico.est.HighPal;
       int x;
+      /* convert straight into the frontend framebuffer if there is one */
+      if (vout_fb != NULL) {
+         pd = vout_fb;
+         pd_pitch = vout_fb_pitch / 2;
+      }
       if (Pico.m.dirtyPal)
          PicoDrawUpdateHighPal();
       /* 8 bit renderers have an extra offset for SMS wíth 1st tile blanked */
@@ -2498,6 +2703,13 @@ void retro_run(void)
             *pd++ = pal[*ps++];
          }
          ps += 320-vout_width; /* Advance to next line in case of 32col mode */
+         pd += pd_pitch-vout_width;
+      }
+
+      if (vout_fb != NULL) {
+         video_cb(vout_fb, vout_width, vout_height, vout_fb_pitch);
+         vout_fb = NULL;
+         return;
       }
    }
 
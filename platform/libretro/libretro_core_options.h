@@ -322,6 +322,22 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "60"
    },
+   {
+      "picodrive_audio_batch",
+      "Audio Batching",
+      NULL,
+      "Number of frames of audio collected before they are handed to the frontend. Larger batches lower the callback overhead at high speeds, at the expense of added latency. 'Fast-Forward' batches only while the frontend is fast-forwarding.",
+      NULL,
+      "audio",
+      {
+         { "1",  "disabled" },
+         { "2",  NULL },
+         { "4",  NULL },
+         { "ff", "Fast-Forward" },
+         { NULL, NULL },
+      },
+      "1"
+   },
    {
       "picodrive_input1",
       "Input Device 1",
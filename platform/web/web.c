@@ -1,6 +1,10 @@
 /*
  * PicoDrive Web Platform Layer
  * Emscripten/asm.js interface for running in browser
+ *
+ * With WEB_WORKER defined this is built to run inside a Web Worker
+ * (see worker.js), where there is no window object and output is passed
+ * on through Module callbacks instead.
  */
 
 #include <stdio.h>
@@ -138,7 +142,7 @@ void emu_video_mode_change(int start_line, int line_count, int start_col, int co
     if (vout_offset > vout_width * (VOUT_MAX_HEIGHT - 1) * 2)
         vout_offset = vout_width * (VOUT_MAX_HEIGHT - 1) * 2;
 
-#ifdef __EMSCRIPTEN__
+#if defined(__EMSCRIPTEN__) && !defined(WEB_WORKER)
     EM_ASM({
         if (typeof window.onVideoModeChange === 'function') {
             window.onVideoModeChange($0, $1);
@@ -169,7 +173,14 @@ void emu_32x_startup(void)
 /* Audio write callback */
 static void snd_write(int len)
 {
-#ifdef __EMSCRIPTEN__
+#if defined(__EMSCRIPTEN__) && defined(WEB_WORKER)
+    /* the worker copies the samples straight from the heap to its ring */
+    EM_ASM({
+        if (typeof Module.onAudioWrite === 'function') {
+            Module.onAudioWrite($0, $1);
+        }
+    }, PicoIn.sndOut, len / 4);
+#elif defined(__EMSCRIPTEN__)
     /* len is in bytes, we have 16-bit stereo samples */
     int samples = len / 4;
     EM_ASM({
@@ -0,0 +1,219 @@
+// PicoDrive Web Worker - runs the emulator core off the page's main thread.
+// Video frames and audio are handed to the page through SharedArrayBuffers
+// (see worker_shared.js), so load on the page doesn't stall emulation.
+// Build with: make -f Makefile.web WORKER=1
+
+importScripts("worker_shared.js")
+
+var Module = {
+  onRuntimeInitialized: function () {
+    _pico_init()
+    postMessage({
+      type: "ready",
+      buttons: {
+        UP: _pico_get_button_up(),
+        DOWN: _pico_get_button_down(),
+        LEFT: _pico_get_button_left(),
+        RIGHT: _pico_get_button_right(),
+        A: _pico_get_button_a(),
+        B: _pico_get_button_b(),
+        C: _pico_get_button_c(),
+        X: _pico_get_button_x(),
+        Y: _pico_get_button_y(),
+        Z: _pico_get_button_z(),
+        START: _pico_get_button_start(),
+        MODE: _pico_get_button_mode(),
+      },
+    })
+  },
+  print: function (text) {
+    console.log("stdout:", text)
+  },
+  printErr: function (text) {
+    console.error("stderr:", text)
+  },
+}
+
+importScripts("picodrive-worker.js")
+
+let ctrl = null
+let video16 = null
+let audio16 = null
+let back = 0 // video slot owned by the worker
+
+let running = false
+let timer = null
+let frameTime = 1000 / 60
+let nextFrameTime = 0
+
+// Audio callback from snd_write() in web.c, samples are stereo int16
+Module.onAudioWrite = function (ptr, samples) {
+  const write = Atomics.load(ctrl, CTRL_AUDIO_WRITE)
+  const read = Atomics.load(ctrl, CTRL_AUDIO_READ)
+  const room = PICO_AUDIO_RING_FRAMES - ((write - read) | 0)
+  const mask = PICO_AUDIO_RING_FRAMES - 1
+  const src = ptr >> 1
+  let n = Math.min(samples, room)
+  let pos = write & mask
+  let done = 0
+
+  // copy in at most 2 parts around the ring end
+  while (done < n) {
+    const len = Math.min(n - done, PICO_AUDIO_RING_FRAMES - pos)
+    audio16.set(
+      Module.HEAP16.subarray(src + done * 2, src + (done + len) * 2),
+      pos * 2
+    )
+    done += len
+    pos = (pos + len) & mask
+  }
+  Atomics.store(ctrl, CTRL_AUDIO_WRITE, (write + n) | 0)
+}
+
+function audioFill() {
+  return (Atomics.load(ctrl, CTRL_AUDIO_WRITE) -
+    Atomics.load(ctrl, CTRL_AUDIO_READ)) | 0
+}
+
+function publishFrame() {
+  const width = _pico_get_video_width()
+  const height = _pico_get_video_height()
+  const src = _pico_get_video_buffer() >> 1
+
+  video16.set(
+    Module.HEAPU16.subarray(src, src + width * height),
+    back * PICO_VIDEO_SLOT_SIZE
+  )
+  Atomics.store(ctrl, CTRL_VIDEO_SIZE + back, (width << 16) | height)
+  // hand the slot over and take back whatever the page didn't pick up
+  back =
+    Atomics.exchange(ctrl, CTRL_VIDEO_MIDDLE, back | CTRL_VIDEO_DIRTY) & 3
+}
+
+function runFrame() {
+  _pico_set_input(0, Atomics.load(ctrl, CTRL_INPUT))
+  _pico_set_input(1, Atomics.load(ctrl, CTRL_INPUT + 1))
+  _pico_run_frame()
+  publishFrame()
+  Atomics.add(ctrl, CTRL_FRAMES, 1)
+}
+
+function loop() {
+  let frames = 0
+  let delay = 0
+
+  timer = null
+  if (!running) {
+    return
+  }
+
+  if (Atomics.load(ctrl, CTRL_AUDIO_ON)) {
+    // paced by audio: keep the ring filled up to the target level
+    while (audioFill() < PICO_AUDIO_TARGET_FRAMES && frames < 4) {
+      runFrame()
+      frames++
+    }
+    if (frames === 0) {
+      // sleep until the AudioWorklet has consumed something
+      const read = Atomics.load(ctrl, CTRL_AUDIO_READ)
+      Atomics.wait(ctrl, CTRL_AUDIO_READ, read, frameTime)
+    }
+    nextFrameTime = performance.now()
+  } else {
+    // no audio output yet: pace by the clock
+    const now = performance.now()
+    if (now - nextFrameTime > 100) {
+      nextFrameTime = now
+    }
+    while (nextFrameTime <= now && frames < 4) {
+      runFrame()
+      nextFrameTime += frameTime
+      frames++
+    }
+    delay = Math.max(0, nextFrameTime - performance.now())
+  }
+
+  timer = setTimeout(loop, delay)
+}
+
+function start() {
+  running = true
+  nextFrameTime = performance.now()
+  if (!timer) {
+    timer = setTimeout(loop, 0)
+  }
+}
+
+function stop() {
+  running = false
+  if (timer) {
+    clearTimeout(timer)
+    timer = null
+  }
+}
+
+onmessage = function (e) {
+  const msg = e.data
+
+  switch (msg.cmd) {
+    case "init":
+      ctrl = new Int32Array(msg.shared.ctrl)
+      video16 = new Uint16Array(msg.shared.video)
+      audio16 = new Int16Array(msg.shared.audio)
+      break
+
+    case "load": {
+      stop()
+      const data = new Uint8Array(msg.data)
+      const ptr = _pico_get_rom_buffer(data.length)
+      if (!ptr) {
+        postMessage({ type: "loaded", ok: false })
+        break
+      }
+      Module.HEAPU8.set(data, ptr)
+      const ok = _pico_load_rom(msg.name) !== 0
+      const pal = ok && _pico_is_pal() !== 0
+      frameTime = pal ? 1000 / 50 : 1000 / 60
+      postMessage({ type: "loaded", ok: ok, pal: pal })
+      if (ok) {
+        start()
+      }
+      break
+    }
+
+    case "reset":
+      _pico_reset()
+      break
+
+    case "pause":
+      if (msg.paused) {
+        stop()
+      } else {
+        start()
+      }
+      break
+
+    case "saveState":
+      if (_pico_state_save()) {
+        const ptr = _pico_get_state_buffer()
+        const size = _pico_get_state_size()
+        const data = Module.HEAPU8.slice(ptr, ptr + size).buffer
+        postMessage({ type: "state", data: data }, [data])
+      } else {
+        postMessage({ type: "state", data: null })
+      }
+      break
+
+    case "loadState": {
+      const data = new Uint8Array(msg.data)
+      const ptr = _pico_get_state_load_buffer(data.length)
+      let ok = false
+      if (ptr) {
+        Module.HEAPU8.set(data, ptr)
+        ok = _pico_state_load() !== 0
+      }
+      postMessage({ type: "stateLoaded", ok: ok })
+      break
+    }
+  }
+}
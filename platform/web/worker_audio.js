@@ -0,0 +1,45 @@
+// PicoDrive Web Worker build - AudioWorklet playing the worker's output.
+// Reads stereo int16 samples from the shared ring described in
+// worker_shared.js; the layout is passed in processorOptions since
+// worklets can't load that file into their scope.
+
+class PicoAudioProcessor extends AudioWorkletProcessor {
+  constructor(options) {
+    super()
+    const opt = options.processorOptions
+    this.ctrl = new Int32Array(opt.ctrl)
+    this.ring = new Int16Array(opt.audio)
+    this.mask = opt.ringFrames - 1
+    this.writeIdx = opt.writeIdx
+    this.readIdx = opt.readIdx
+  }
+
+  process(inputs, outputs) {
+    const out = outputs[0]
+    const left = out[0]
+    const right = out.length > 1 ? out[1] : out[0]
+    const ctrl = this.ctrl
+    const ring = this.ring
+    const read = Atomics.load(ctrl, this.readIdx)
+    const avail = (Atomics.load(ctrl, this.writeIdx) - read) | 0
+    const n = Math.min(left.length, avail)
+    let i
+
+    for (i = 0; i < n; i++) {
+      const idx = ((read + i) & this.mask) * 2
+      left[i] = ring[idx] / 32768
+      right[i] = ring[idx + 1] / 32768
+    }
+    // underrun: pad with silence
+    for (; i < left.length; i++) {
+      left[i] = right[i] = 0
+    }
+
+    Atomics.store(ctrl, this.readIdx, (read + n) | 0)
+    // wake up the worker waiting for room in the ring
+    Atomics.notify(ctrl, this.readIdx)
+    return true
+  }
+}
+
+registerProcessor("pico-audio", PicoAudioProcessor)
@@ -0,0 +1,41 @@
+// PicoDrive Web Worker build - layout of the shared memory
+// Loaded by both the page (worker.html) and the worker (worker.js).
+//
+// Three SharedArrayBuffers are exchanged between page and worker:
+//  ctrl  - Int32Array of control words (indices below)
+//  video - 3 RGB565 frame slots (triple buffer, swapped with Atomics)
+//  audio - Int16Array stereo sample ring, written by the worker and
+//          read by the AudioWorklet (worker_audio.js)
+
+var PICO_VOUT_MAX_WIDTH = 320
+var PICO_VOUT_MAX_HEIGHT = 240
+var PICO_VIDEO_SLOTS = 3
+var PICO_VIDEO_SLOT_SIZE = PICO_VOUT_MAX_WIDTH * PICO_VOUT_MAX_HEIGHT
+
+// audio ring size in stereo sample frames, must be a power of 2
+var PICO_AUDIO_RING_FRAMES = 8192
+// fill level the worker keeps the ring at (~70ms at 44.1kHz)
+var PICO_AUDIO_TARGET_FRAMES = 3072
+
+// ctrl word indices
+var CTRL_VIDEO_MIDDLE = 0 // slot handed over, | CTRL_VIDEO_DIRTY if new
+var CTRL_VIDEO_SIZE = 1 // 3 words: (width << 16) | height per slot
+var CTRL_INPUT = 4 // 2 words: pad state for player 1 and 2
+var CTRL_AUDIO_WRITE = 6 // sample frames written (wraps at 2^31)
+var CTRL_AUDIO_READ = 7 // sample frames read
+var CTRL_AUDIO_ON = 8 // set by the page while the AudioWorklet is running
+var CTRL_FRAMES = 9 // emulated frames, for status display
+var CTRL_WORDS = 16
+
+var CTRL_VIDEO_DIRTY = 4
+
+function picoCreateShared() {
+  const shared = {
+    ctrl: new SharedArrayBuffer(CTRL_WORDS * 4),
+    video: new SharedArrayBuffer(PICO_VIDEO_SLOTS * PICO_VIDEO_SLOT_SIZE * 2),
+    audio: new SharedArrayBuffer(PICO_AUDIO_RING_FRAMES * 2 * 2),
+  }
+  // worker starts writing slot 0, page starts displaying slot 2
+  new Int32Array(shared.ctrl)[CTRL_VIDEO_MIDDLE] = 1
+  return shared
+}
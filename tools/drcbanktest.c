@@ -0,0 +1,181 @@
+// gcc drcbanktest.c cpu/drc/cmn.c -I. -Ipico/sound -DDRC_SH2 -falign-functions=2 -g -O -o drcbanktest
+//
+// checks that SH2 code with folded ROM constants isn't reused after a state
+// load or a ROM bank switch which mapped other data to the folded addresses
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+#include <cpu/sh2/compiler.c>
+#include <pico/memory.h>
+
+#define MAP_MEMORY(m) ((uptr)(m) >> 1)
+#define MAP_HANDLER(h) ( ((uptr)(h) >> 1) | ((uptr)1 << (sizeof(uptr) * 8 - 1)) )
+
+struct Pico Pico;
+PicoInterface PicoIn;
+SH2 sh2s[2];
+struct Pico32xMem _Pico32xMem, *Pico32xMem = &_Pico32xMem;
+struct Pico32x Pico32x;
+
+int carthw_ssf2_active;
+unsigned char carthw_ssf2_banks[8];
+
+// 2 ROM banks of 512KB, the 1st word tells them apart
+static u32 rom[2 * 0x80000 / 4];
+
+static const u16 code[] = {
+  0xd101,             // mov.l  @(lit,pc),r1
+  0x6012,             // mov.l  @r1,r0     <- folded ROM read
+  0xaffe,             // bra    .
+  0x0009,             // nop
+  0x0208, 0x0000,     // lit:   .long 0x02080000 (ROM bank slot 1)
+};
+
+static sh2_memmap read8_map[0x80], read16_map[0x80], read32_map[0x80];
+static const void *write8_tab[0x80], *write16_tab[0x80], *write32_tab[0x80];
+
+void lprintf(const char *fmt, ...)
+{
+  va_list vl;
+
+  va_start(vl, fmt);
+  vprintf(fmt, vl);
+  va_end(vl);
+}
+
+void memset32(void *dest_in, int c, int count) { memset(dest_in, c, 4*count); }
+
+void *plat_mem_get_for_drc(size_t size) { return NULL; }
+int plat_mem_set_exec(void *ptr, size_t size)
+{
+  return mprotect(ptr, size, PROT_READ|PROT_WRITE|PROT_EXEC);
+}
+
+static u32 REGPARM(2) read32_rom(u32 a, SH2 *sh2)
+{
+  u32 bank = carthw_ssf2_banks[(a >> 19) & 7] << 19;
+  return rom[(bank + (a & 0x7fffc)) / 4];
+}
+
+static u32 REGPARM(2) read16_rom(u32 a, SH2 *sh2)
+{
+  u32 d = read32_rom(a, sh2);
+  return (s16)(a & 2 ? d : d >> 16);
+}
+
+static u32 REGPARM(2) read8_rom(u32 a, SH2 *sh2)
+{
+  u32 d = read16_rom(a, sh2);
+  return (s8)(a & 1 ? d : d >> 8);
+}
+
+static u32 REGPARM(2) read_none(u32 a, SH2 *sh2) { return 0; }
+static void REGPARM(3) write_none(u32 a, u32 d, SH2 *sh2) { }
+
+void *p32x_sh2_get_mem_ptr(u32 a, u32 *mask, SH2 *sh2)
+{
+  if ((a & 0xc6000000) == 0x06000000) {
+    *mask = 0x3ffff;
+    return sh2->p_sdram;
+  }
+  if ((a & 0xc6000000) == 0x02000000) {
+    *mask = 0x7ffff;
+    return (char *)sh2->p_rom + (carthw_ssf2_banks[(a >> 19) & 7] << 19);
+  }
+  return (void *)-1;
+}
+
+int p32x_sh2_mem_is_rom(u32 a, SH2 *sh2)
+{
+  return (a & 0xc6000000) == 0x02000000;
+}
+
+u32 REGPARM(2) p32x_sh2_read8 (u32 a, SH2 *s) { return read8_rom(a, s); }
+u32 REGPARM(2) p32x_sh2_read16(u32 a, SH2 *s) { return read16_rom(a, s); }
+u32 REGPARM(2) p32x_sh2_read32(u32 a, SH2 *s) { return read32_rom(a, s); }
+
+void REGPARM(3) p32x_sh2_write32(u32 a, u32 d, SH2 *s) { }
+
+u32 REGPARM(3) p32x_sh2_poll_memory8 (u32 a, u32 d, SH2 *s) { return d; }
+u32 REGPARM(3) p32x_sh2_poll_memory16(u32 a, u32 d, SH2 *s) { return d; }
+u32 REGPARM(3) p32x_sh2_poll_memory32(u32 a, u32 d, SH2 *s) { return d; }
+
+static void mem_setup(SH2 *sh2)
+{
+  int i;
+
+  for (i = 0; i < 0x80; i++) {
+    read8_map[i].addr  = MAP_HANDLER(read_none);
+    read16_map[i].addr = MAP_HANDLER(read_none);
+    read32_map[i].addr = MAP_HANDLER(read_none);
+    write8_tab[i] = write16_tab[i] = write32_tab[i] = write_none;
+  }
+  read8_map[0x02/2].addr  = MAP_HANDLER(read8_rom);
+  read16_map[0x02/2].addr = MAP_HANDLER(read16_rom);
+  read32_map[0x02/2].addr = MAP_HANDLER(read32_rom);
+  read8_map[0x06/2].addr  = read16_map[0x06/2].addr  =
+  read32_map[0x06/2].addr = MAP_MEMORY(Pico32xMem->sdram);
+  read8_map[0x06/2].mask  = read16_map[0x06/2].mask  =
+  read32_map[0x06/2].mask = 0x3ffff;
+
+  sh2->read8_map = read8_map;
+  sh2->read16_map = read16_map;
+  sh2->read32_map = read32_map;
+  sh2->write8_tab = write8_tab;
+  sh2->write16_tab = write16_tab;
+  sh2->write32_tab = write32_tab;
+  sh2->p_sdram = Pico32xMem->sdram;
+  sh2->p_rom = rom;
+  sh2_drc_mem_setup(sh2);
+}
+
+static u32 run(SH2 *sh2)
+{
+  sh2->pc = 0x06000000;
+  sh2->r[0] = sh2->r[1] = 0;
+  sh2->sr = 0xf0;
+  sh2_execute_drc(sh2, 100);
+  return sh2->r[0];
+}
+
+static int check(const char *what, u32 r0, u32 expect)
+{
+  printf("%-28s r0 %08x %s\n", what, r0, r0 == expect ? "ok" : "FAIL");
+  return r0 != expect;
+}
+
+int main(int argc, char *argv[])
+{
+  SH2 *sh2 = &sh2s[0];
+  int fail = 0;
+
+  rom[0] = 0x11111111;
+  rom[0x80000 / 4] = 0x22222222;
+  memcpy(Pico32xMem->sdram, code, sizeof(code));
+
+  mem_setup(sh2);
+  if (sh2_drc_init(sh2)) {
+    printf("drc init failed\n");
+    return 1;
+  }
+
+  // bank 0 mapped at slot 1, its data is folded into the block
+  carthw_ssf2_active = 1;
+  fail |= check("bank 0", run(sh2), 0x11111111);
+
+  // state load which restores another bank at slot 1
+  carthw_ssf2_banks[1] = 1;
+  sh2_drc_state_loaded();
+  fail |= check("state load, bank 1", run(sh2), 0x22222222);
+
+  // bank switch back to bank 0, block from the 1st run can be reused
+  carthw_ssf2_banks[1] = 0;
+  if (Pico32x.emu_flags & P32XF_DRC_ROM_C)
+    sh2_drc_rom_banked();
+  fail |= check("bank switch, bank 0", run(sh2), 0x11111111);
+
+  sh2_drc_finish(sh2);
+  return fail;
+}
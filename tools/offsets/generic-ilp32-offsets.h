@@ -7,29 +7,35 @@
 #define OFS_Pico_m_hardware  0x0047
 #define OFS_Pico_m_z80_reset 0x004f
 #define OFS_Pico_m_sram_reg  0x0049
-#define OFS_Pico_sv          0x008c
-#define OFS_Pico_sv_data     0x008c
-#define OFS_Pico_sv_start    0x0090
-#define OFS_Pico_sv_end      0x0094
-#define OFS_Pico_sv_flags    0x0098
-#define OFS_Pico_rom         0x0554
-#define OFS_Pico_romsize     0x0558
-#define OFS_Pico_est         0x00c8
+#define OFS_Pico_sv          0x00b0
+#define OFS_Pico_sv_data     0x00b0
+#define OFS_Pico_sv_start    0x00b4
+#define OFS_Pico_sv_end      0x00b8
+#define OFS_Pico_sv_flags    0x00bc
+#define OFS_Pico_rom         0x059c
+#define OFS_Pico_romsize     0x05a0
+#define OFS_Pico_est         0x0104
+#define OFS_PicoIn_opt       0x0000
+#define OFS_PicoIn_filter    0x0030
+#define OFS_PicoIn_AHW       0x0014
 #define OFS_EST_DrawScanline 0x0000
 #define OFS_EST_rendstatus   0x0004
 #define OFS_EST_DrawLineDest 0x0008
-#define OFS_EST_HighCol      0x000c
-#define OFS_EST_HighPreSpr   0x0010
-#define OFS_EST_Pico         0x0014
-#define OFS_EST_PicoMem_vram 0x0018
-#define OFS_EST_PicoMem_cram 0x001c
-#define OFS_EST_PicoOpt      0x0020
-#define OFS_EST_Draw2FB      0x0024
-#define OFS_EST_HighPal      0x0028
+#define OFS_EST_DrawLineDestIncr 0x000c
+#define OFS_EST_HighCol      0x0010
+#define OFS_EST_HighPreSpr   0x0014
+#define OFS_EST_Pico         0x0018
+#define OFS_EST_PicoMem_vram 0x001c
+#define OFS_EST_PicoMem_cram 0x0020
+#define OFS_EST_PicoOpt      0x0024
+#define OFS_EST_Draw2FB      0x0028
+#define OFS_EST_Draw2Width   0x002c
+#define OFS_EST_Draw2Start   0x0030
+#define OFS_EST_HighPal      0x0034
 #define OFS_PMEM_vram        0x10000
 #define OFS_PMEM_vsram       0x22100
 #define OFS_PMEM32x_pal_native 0x90e00
-#define OFS_SH2_is_slave     0x055c
+#define OFS_SH2_is_slave     0x0760
 #define OFS_SH2_p_bios       0x0080
 #define OFS_SH2_p_da         0x0084
 #define OFS_SH2_p_sdram      0x0088